@@ -4,25 +4,33 @@
 #include <assert.h>
 #include "list"
 #include "map"
+#include "vector"
 #include "err.hpp"
+#include "emitter.hpp"
 #include "symbol_table.hpp"
 
 namespace holeyc{
 
 class TypeAnalysis;
+class ASTNode;
+class IDNode;
 class Procedure;
 class IRProgram;
 
 class Label{
 public:
-	Label(std::string nameIn){
+	Label(std::string nameIn) : proc(nullptr), num(0){
 		this->name = nameIn;
 	}
-	std::string toString(){
-		return "lbl_" + this->name;
-	}
+	//A label numbered within its procedure, which names it when
+	// the program is printed
+	Label(Procedure * procIn, size_t numIn) : proc(procIn), num(numIn){ }
+	void emit(Emitter& out);
+	std::string toString();
 private:
 	std::string name;
+	Procedure * proc;
+	size_t num;
 };
 
 enum OpdWidth{
@@ -32,7 +40,9 @@ enum OpdWidth{
 class Opd{
 public:
 	Opd(OpdWidth widthIn) : myWidth(widthIn){}
-	virtual std::string toString() = 0;
+	virtual ~Opd(){ }
+	virtual void emit(Emitter& out) = 0;
+	std::string toString();
 	virtual OpdWidth getWidth(){ return myWidth; }
 	static OpdWidth width(const DataType * type){
 		if (const BasicType * basic = type->asBasic()){
@@ -50,8 +60,8 @@ private:
 class SymOpd : public Opd{
 public:
 	SymOpd(OpdWidth width) : Opd(width){}
-	virtual std::string toString() override{
-		return mySym->getName();
+	virtual void emit(Emitter& out) override{
+		out << mySym->getName();
 	}
 	const SemSymbol * getSym(){ return mySym; }
 private:
@@ -63,23 +73,37 @@ private:
 	friend class IRProgram;
 };
 
+//The address of a string literal, which is numbered and named
+// the same way as a label
+class StrOpd : public Opd{
+public:
+	StrOpd(Procedure * procIn, size_t numIn)
+	: Opd(ADDR), proc(procIn), num(numIn){ }
+	void emit(Emitter& out) override;
+private:
+	Procedure * proc;
+	size_t num;
+};
+
+//Every literal is lowered to a number: characters and bools to
+// their values, null to 0
 class LitOpd : public holeyc::Opd{
 public:
-	LitOpd(std::string valIn, OpdWidth width)
+	LitOpd(long long valIn, OpdWidth width)
 	: Opd(width), val(valIn){ }
-	std::string toString() override{
-		return val;
+	void emit(Emitter& out) override{
+		out.putInt(val);
 	}
 private:
-	std::string val;
+	long long val;
 };
 
 class AuxOpd : public Opd{
 public:
 	AuxOpd(std::string valIn, OpdWidth width) 
 	: Opd(width), val(valIn) { }
-	std::string toString() override{
-		return val;
+	void emit(Emitter& out) override{
+		out << val;
 	}
 private:
 	std::string val;
@@ -98,11 +122,13 @@ enum Intrinsic {
 class Quad{
 public:
 	Quad();
+	virtual ~Quad(){ }
 	void addLabel(Label * label);
 	Label * getLabel(){ return labels.front(); }
-	virtual std::string repr() = 0;
-	std::string commentStr();
-	virtual std::string toString(bool verbose=false);
+	//Write the quad, without its labels or comment
+	virtual void repr(Emitter& out) = 0;
+	void emit(Emitter& out, bool verbose=false);
+	std::string toString(bool verbose=false);
 	void setComment(std::string commentIn);
 private:
 	std::string myComment;
@@ -112,7 +138,7 @@ private:
 class BinOpQuad : public Quad{
 public:
 	BinOpQuad(Opd * dstIn, BinOp opIn, Opd * src1In, Opd * src2In);
-	std::string repr() override;
+	void repr(Emitter& out) override;
 private:
 	Opd * dst;
 	BinOp op;
@@ -123,7 +149,7 @@ private:
 class UnaryOpQuad : public Quad {
 public:
 	UnaryOpQuad(Opd * dstIn, UnaryOp opIn, Opd * srcIn);
-	std::string repr() override ;
+	void repr(Emitter& out) override;
 private:
 	Opd * dst;
 	UnaryOp op;
@@ -136,7 +162,7 @@ public:
 	AssignQuad(Opd * dstIn, Opd * srcIn)
 	: dst(dstIn), src(srcIn)
 	{ }
-	std::string repr() override;
+	void repr(Emitter& out) override;
 
 private:
 	Opd * dst;
@@ -146,7 +172,7 @@ private:
 class LocQuad : public Quad {
 public:
 	LocQuad(Opd * srcIn, Opd * tgtIn);
-	std::string repr() override;
+	void repr(Emitter& out) override;
 private:
 	Opd * src;
 	Opd * tgt;
@@ -155,7 +181,7 @@ private:
 class JmpQuad : public Quad {
 public:
 	JmpQuad(Label * tgtIn);
-	std::string repr() override;
+	void repr(Emitter& out) override;
 private:
 	Label * tgt;
 };
@@ -163,7 +189,7 @@ private:
 class JmpIfQuad : public Quad {
 public:
 	JmpIfQuad(Opd * cndIn, Label * tgtIn);
-	std::string repr() override;
+	void repr(Emitter& out) override;
 private:
 	Opd * cnd;
 	Label * tgt;
@@ -172,13 +198,13 @@ private:
 class NopQuad : public Quad {
 public:
 	NopQuad();
-	std::string repr() override;
+	void repr(Emitter& out) override;
 };
 
 class IntrinsicQuad : public Quad {
 public:
 	IntrinsicQuad(Intrinsic intrinsic, Opd * arg);
-	std::string repr() override;
+	void repr(Emitter& out) override;
 private:
 	Opd * myArg;
 	Intrinsic myIntrinsic;
@@ -187,7 +213,7 @@ private:
 class CallQuad : public Quad{
 public:
 	CallQuad(SemSymbol * calleeIn);
-	std::string repr() override;
+	void repr(Emitter& out) override;
 private:
 	SemSymbol * callee;
 };
@@ -195,7 +221,7 @@ private:
 class EnterQuad : public Quad{
 public:
 	EnterQuad(Procedure * proc);
-	virtual std::string repr() override;
+	virtual void repr(Emitter& out) override;
 private:
 	Procedure * myProc;
 };
@@ -203,7 +229,7 @@ private:
 class LeaveQuad : public Quad{
 public:
 	LeaveQuad(Procedure * proc);
-	virtual std::string repr() override;
+	virtual void repr(Emitter& out) override;
 private:
 	Procedure * myProc;
 };
@@ -211,7 +237,7 @@ private:
 class SetArgQuad : public Quad{
 public:
 	SetArgQuad(size_t indexIn, Opd * opdIn);
-	std::string repr() override;
+	void repr(Emitter& out) override;
 private:
 	size_t index;
 	Opd * opd;
@@ -220,7 +246,7 @@ private:
 class GetArgQuad : public Quad{
 public:
 	GetArgQuad(size_t indexIn, Opd * opdIn);
-	std::string repr() override;
+	void repr(Emitter& out) override;
 private:
 	size_t index;
 	Opd * opd;
@@ -229,7 +255,7 @@ private:
 class SetRetQuad : public Quad{
 public:
 	SetRetQuad(Opd * opdIn);
-	std::string repr() override;
+	void repr(Emitter& out) override;
 private:
 	size_t index;
 	Opd * opd;
@@ -238,15 +264,44 @@ private:
 class GetRetQuad : public Quad{
 public:
 	GetRetQuad(Opd * opdIn);
-	std::string repr() override;
+	void repr(Emitter& out) override;
 private:
 	size_t index;
 	Opd * opd;
 };
 
+//The rendered 3AC of a procedure, kept so that the function it
+// came from can be spliced into a later program without being
+// analyzed or lowered again. Its labels and string literals are
+// numbered from 0, as within any procedure.
+struct ProcTemplate{
+	//How many numbered labels the procedure made
+	size_t labels = 0;
+	//The values of its string literals, in the order made
+	std::vector<std::string> strings;
+	//The procedure's 3AC, with each label and string reference
+	// written as a marker: LABEL_MARK or STR_MARK, the number
+	// within the template, then END_MARK
+	std::string text;
+
+	static const char LABEL_MARK = '\x01';
+	static const char STR_MARK = '\x02';
+	static const char END_MARK = '\x03';
+};
+
+//Each procedure numbers its labels and string literals from 0,
+// so that procedures can be lowered independently of each other.
+// The program gives them their final numbers, in the order the
+// procedures were made, once they are all lowered.
 class Procedure{
 public:
 	Procedure(IRProgram * prog, std::string name);
+	//A procedure spliced in from a template, rather than lowered
+	Procedure(IRProgram * prog, std::string name,
+	  const ProcTemplate * templateIn);
+	//Frees the procedure's quads and the operands and labels it
+	// made. The program's globals are left alone.
+	~Procedure();
 	void addQuad(Quad * quad);
 	Quad * popQuad();
 	IRProgram * getProg();
@@ -257,43 +312,109 @@ public:
 	void gatherFormal(SemSymbol * sym);
 	SymOpd * getSymOpd(SemSymbol * sym);
 	AuxOpd * makeTmp(OpdWidth width);
+	LitOpd * makeLit(long long val, OpdWidth width);
+	Opd * makeString(std::string val);
 
+	void emit(Emitter& out, bool verbose=false);
 	std::string toString(bool verbose=false); 
-	std::string getName();
+	const std::string& getName();
 
 	holeyc::Label * getLeaveLabel();
+
+	//The function declaration this procedure was lowered from
+	void setDecl(const ASTNode * declIn){ myDecl = declIn; }
+	const ASTNode * getDecl() const { return myDecl; }
+	//Whether the procedure was spliced in from a template
+	bool isSpliced() const { return spliced != nullptr; }
+	//The procedure as a template, to splice in elsewhere
+	ProcTemplate toTemplate();
+
+	//Write the names of this procedure's labels and strings
+	void emitLabel(Emitter& out, size_t num);
+	void emitStr(Emitter& out, size_t num);
 private:
+	//The program numbers the procedure's labels and strings
+	friend class IRProgram;
+
 	EnterQuad * enter;
 	Quad * leave;
 	Label * leaveLabel;
 
 	IRProgram * myProg;
-	std::map<SemSymbol *, SymOpd *> locals;
+	HashMap<SemSymbol *, SymOpd *> locals;
+	//The locals again, in the order they were declared, which
+	// is the order they are printed in
+	std::list<SymOpd *> localOrder;
 	std::list<AuxOpd *> temps; 
 	std::list<SymOpd *> formals; 
+	std::list<LitOpd *> literals;
+	std::list<StrOpd *> strOpds;
+	std::list<Label *> labels;
 	std::list<Quad *> bodyQuads;
 	std::string myName;
 	size_t maxTmp;
+
+	const ASTNode * myDecl = nullptr;
+	size_t labelCount = 0;
+	//The values of the procedure's string literals, in the order
+	// they were made
+	std::vector<std::string> strings;
+	//Once numbered, label (or string) n of this procedure is
+	// labelBase + n (or strBase + n) in the program
+	bool numbered = false;
+	size_t labelBase = 0;
+	size_t strBase = 0;
+	//While the procedure is rendered as a template, its labels
+	// and strings are printed as markers instead
+	bool templating = false;
+	const ProcTemplate * spliced = nullptr;
 };
 
 class IRProgram{
 public:
-	IRProgram(TypeAnalysis * taIn) : ta(taIn){}
+	//Procedures are rendered on up to threadsIn threads, 0 for
+	// one per hardware thread
+	IRProgram(TypeAnalysis * taIn, size_t threadsIn = 1)
+	: ta(taIn), threads(threadsIn){}
+	//Lower each function with a different type analysis, for
+	// a program compiled one declaration at a time
+	void setTypeAnalysis(TypeAnalysis * taIn){ ta = taIn; }
 	Procedure * makeProc(std::string name);
-	Label * makeLabel();
-	Opd * makeString(std::string val);
+	//Splice in a procedure lowered by an earlier compilation
+	Procedure * spliceProc(std::string name, const ProcTemplate * tmpl);
+	//The template for the function declared by fn, if the
+	// compilation is reusing one
+	const ProcTemplate * reusedProc(const ASTNode * fn);
 	void gatherGlobal(SemSymbol * sym);
 	SymOpd * getGlobal(SemSymbol * sym);
 	OpdWidth opWidth(ASTNode * node);
+	SemSymbol * symbolOf(const IDNode * id);
 
+	void emit(Emitter& out, bool verbose=false);
 	std::string toString(bool verbose=false);
+	//The globals section that starts the program's 3AC
+	void emitGlobals(Emitter& out);
+	//Render the procedures lowered so far onto out, then free
+	// them. They are left out of emit() from then on.
+	void flushProcs(Emitter& out, bool verbose=false);
+	const std::list<Procedure *>& getProcs(){ return procs; }
 private:
+	//Give the procedures made since the last call their
+	// program-wide label and string numbers
+	void numberProcs();
+
 	TypeAnalysis * ta;
+	size_t threads;
+	//Labels and strings numbered so far
 	size_t max_label = 0;
 	size_t str_idx = 0;
 	std::list<Procedure *> procs; 
-	HashMap<AuxOpd *, std::string> strings;
-	std::map<SemSymbol *, SymOpd *> globals;
+	//The value of each string literal, by number, which is the
+	// order they are printed in
+	std::vector<std::string> strings;
+	HashMap<SemSymbol *, SymOpd *> globals;
+	//The globals again, in declaration order, for printing
+	std::list<SymOpd *> globalOrder;
 };
 
 }
@@ -0,0 +1,101 @@
+#ifndef HOLEYC_ARENA_HPP
+#define HOLEYC_ARENA_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace holeyc{
+
+//A bump allocator. Objects are carved out of large blocks by
+// moving a cursor forward, and are never freed one at a time:
+// everything allocated in the arena is released at once by
+// reset() or when the arena is destroyed. Objects that need a
+// destructor run (e.g. ones holding a std::string) have it run
+// at release time, in reverse order of construction.
+class Arena{
+public:
+	Arena(size_t blockSizeIn = 64 * 1024);
+	~Arena();
+
+	void * allocate(size_t size, size_t align);
+
+	template <typename T, typename... Args>
+	T * make(Args&&... args){
+		void * mem = allocate(sizeof(T), alignof(T));
+		T * obj = new (mem) T(std::forward<Args>(args)...);
+		if (!std::is_trivially_destructible<T>::value){
+			addCleanup(&destroy<T>, obj);
+		}
+		return obj;
+	}
+
+	//Release everything allocated so far. The first block is
+	// kept around so that a reused arena doesn't have to go
+	// back to the system allocator.
+	void reset();
+
+	size_t bytesUsed() const { return used; }
+private:
+	struct Block{
+		Block * prev;
+		size_t size;
+	};
+	struct Cleanup{
+		void (*fn)(void *);
+		void * obj;
+		Cleanup * next;
+	};
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	template <typename T>
+	static void destroy(void * obj){
+		static_cast<T *>(obj)->~T();
+	}
+	void addCleanup(void (*fn)(void *), void * obj);
+	void runCleanups();
+	char * newBlock(size_t minSize);
+
+	size_t blockSize;
+	Block * head = nullptr;
+	char * cursor = nullptr;
+	char * limit = nullptr;
+	Cleanup * cleanups = nullptr;
+	size_t used = 0;
+};
+
+//Standard allocator handing out memory from an Arena, so that
+// containers (e.g. the child lists of the AST) can live in one.
+// Deallocation is a no-op: the memory comes back when the arena
+// is released.
+template <typename T>
+class ArenaAllocator{
+public:
+	typedef T value_type;
+	ArenaAllocator(Arena * arenaIn) : arena(arenaIn){ }
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) 
+	: arena(other.arena){ }
+	T * allocate(size_t n){
+		return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+	}
+	void deallocate(T *, size_t){ }
+	template <typename U>
+	bool operator==(const ArenaAllocator<U>& other) const {
+		return arena == other.arena;
+	}
+	template <typename U>
+	bool operator!=(const ArenaAllocator<U>& other) const {
+		return arena != other.arena;
+	}
+private:
+	template <typename U> friend class ArenaAllocator;
+	Arena * arena;
+};
+
+}
+
+#endif
@@ -5,10 +5,13 @@
 #include <sstream>
 #include <string.h>
 #include <list>
+#include <vector>
+#include <cstdint>
 #include "err.hpp"
 #include "tokens.hpp"
 #include "types.hpp"
 #include "3ac.hpp"
+#include "arena.hpp"
 
 namespace holeyc {
 
@@ -16,7 +19,6 @@ class TypeAnalysis;
 
 class Opd;
 
-class SymbolTable;
 class SemSymbol;
 
 class DerefNode;
@@ -25,6 +27,7 @@ class DeclListNode;
 class StmtListNode;
 class FormalsListNode;
 class DeclNode;
+class FnDeclNode;
 class VarDeclNode;
 class StmtNode;
 class AssignExpNode;
@@ -34,90 +37,136 @@ class StructTypeNode;
 class ExpNode;
 class LValNode;
 class IDNode;
+class ASTBuilder;
+class NameWalker;
+
+//Dense index of an AST node. The parser numbers nodes from 0
+// in the order it builds them, so any per-node annotation can
+// live in a vector indexed by node ID (see NodeTable).
+typedef uint32_t NodeID;
+
+//The children of an AST node. Lists are allocated in the same
+// arena as the nodes they belong to.
+template <typename T>
+using NodeList = std::list<T, ArenaAllocator<T>>;
 
 class ASTNode{
 public:
-	ASTNode(size_t lineIn, size_t colIn)
-	: l(lineIn), c(colIn){ }
-	virtual void unparse(std::ostream&, int) = 0;
-	size_t line() const { return this->l; }
-	size_t col() const { return this->c; }
-	std::string pos(){
-		return "[" + std::to_string(line()) + ","
-			+ std::to_string(col()) + "]";
-	}
+	ASTNode(SrcOffset offsetIn)
+	: myOffset(offsetIn), myNodeID(NO_NODE_ID){ }
+	//Where the node starts in the input. A SourceManager
+	// turns this into a line and column when it is reported
+	SrcOffset offset() const { return myOffset; }
+	NodeID nodeID() const { return myNodeID; }
+	static const NodeID NO_NODE_ID = UINT32_MAX;
 	virtual std::string nodeKind() = 0;
-	virtual bool nameAnalysis(SymbolTable *) = 0;
+	//Bind the declarations and resolve the identifiers of
+	// the subtree, returning false if any of it failed
+	virtual bool nameAnalysis(NameWalker * names) = 0;
+	//Print the subtree back out as source, indent tabs in
+	virtual void unparse(std::ostream& out, int indent) = 0;
 	//Note that there is no ASTNode::typeAnalysis. To allow
 	// for different type signatures, type analysis is 
 	// implemented as needed in various subclasses
 private:
-	size_t l;
-	size_t c;
+	friend class ASTBuilder;
+	SrcOffset myOffset;
+	NodeID myNodeID;
+};
+
+//A side table holding one value of type V for every node in
+// an AST, indexed by node ID. Phases use these to annotate 
+// nodes (with types, for example) without touching the nodes
+// themselves and without hashing node pointers.
+template <typename V>
+class NodeTable{
+public:
+	NodeTable(size_t nodeCount, const V& init = V())
+	: myValues(nodeCount, init){ }
+	V& operator[](const ASTNode * node){
+		return myValues[index(node->nodeID())];
+	}
+	const V& operator[](const ASTNode * node) const {
+		return myValues[index(node->nodeID())];
+	}
+	V& operator[](NodeID id){ return myValues[index(id)]; }
+	const V& operator[](NodeID id) const { return myValues[index(id)]; }
+	size_t size() const { return myValues.size(); }
+private:
+	size_t index(NodeID id) const {
+		if (id >= myValues.size()){
+			throw new InternalError("Node not in side table");
+		}
+		return id;
+	}
+	std::vector<V> myValues;
 };
 
 class ProgramNode : public ASTNode{
 public:
-	ProgramNode(std::list<DeclNode *> * globalsIn)
-	: ASTNode(1,1), myGlobals(globalsIn){}
+	ProgramNode(NodeList<DeclNode *> * globalsIn)
+	: ASTNode(0), myGlobals(globalsIn), myNodeCount(0){}
+	//Number of node IDs handed out while building this AST,
+	// i.e. the size of a side table covering every node
+	size_t nodeCount() const { return myNodeCount; }
+	void setNodeCount(size_t count){ myNodeCount = count; }
+	NodeList<DeclNode *> * getGlobals() const { return myGlobals; }
 	virtual std::string nodeKind() override { return "Program"; }
-	void unparse(std::ostream&, int) override;
-	virtual bool nameAnalysis(SymbolTable *) override;
 	virtual void typeAnalysis(TypeAnalysis *);
-	IRProgram * to3AC(TypeAnalysis * ta);
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
+	//Lower the program, with the functions lowered and rendered
+	// on up to threads threads (0 for one per hardware thread)
+	IRProgram * to3AC(TypeAnalysis * ta, size_t threads = 1);
 	virtual ~ProgramNode(){ }
 private:
-	std::list<DeclNode *> * myGlobals;
+	NodeList<DeclNode *> * myGlobals;
+	size_t myNodeCount;
 };
 
 class ExpNode : public ASTNode{
 public:
-	ExpNode(size_t lIn, size_t cIn) : ASTNode(lIn, cIn){ }
+	ExpNode(SrcOffset offsetIn) : ASTNode(offsetIn){ }
+	//Print the expression as an operand, in parens unless it
+	// can't be split up
 	virtual void unparseNested(std::ostream& out);
-	virtual void unparse(std::ostream& out, int indent) override = 0;
-	virtual bool nameAnalysis(SymbolTable * symTab) override = 0;
 	virtual void typeAnalysis(TypeAnalysis *) = 0;
 	virtual Opd * flatten(Procedure * proc) = 0;
 };
 
 class LValNode : public ExpNode{
 public:
-	LValNode(size_t lIn, size_t cIn) : ExpNode(lIn, cIn){}
+	LValNode(SrcOffset offsetIn) : ExpNode(offsetIn){}
 	virtual std::string nodeKind() override { return "LVal"; }
-	void unparse(std::ostream& out, int indent) override = 0;
 	void unparseNested(std::ostream& out) override;
-	void attachSymbol(SemSymbol * symbolIn) { } 
-	bool nameAnalysis(SymbolTable * symTab) override { return false; }
 	virtual void typeAnalysis(TypeAnalysis *) override {; } 
 	virtual Opd * flatten(Procedure * proc) override = 0;
 };
 
 class IDNode : public LValNode{
 public:
-	IDNode(size_t lIn, size_t cIn, std::string nameIn)
-	: LValNode(lIn, cIn), name(nameIn){}
-	std::string getName(){ return name; }
+	IDNode(SrcOffset offsetIn, Ident nameIn)
+	: LValNode(offsetIn), name(nameIn){}
+	const std::string& getName() const { return name.text(); }
+	Ident getIdent() const { return name; }
 	virtual std::string nodeKind() override { return "ID"; }
-	void unparse(std::ostream& out, int indent) override;
-	void attachSymbol(SemSymbol * symbolIn);
-	SemSymbol * getSymbol() const { return mySymbol; }
-	bool nameAnalysis(SymbolTable * symTab) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * proc) override;
 private:
-	std::string name;
-	SemSymbol * mySymbol = nullptr;
+	Ident name;
 };
 
 class RefNode : public LValNode{
 public:
-	RefNode(size_t l, size_t c, IDNode * id)
-	: LValNode(l, c), myID(id){ }
-	void unparse(std::ostream& out, int indent) override;
+	RefNode(SrcOffset offsetIn, IDNode * id)
+	: LValNode(offsetIn), myID(id){ }
 	std::string nodeKind() override { return "Ref"; }
 
-	virtual bool nameAnalysis(SymbolTable *) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * prog) override;
 private:
 	IDNode * myID;
@@ -125,12 +174,12 @@ private:
 
 class DerefNode : public LValNode{
 public:
-	DerefNode(size_t l, size_t c, IDNode * id)
-	: LValNode(l, c), myID(id){ }
-	void unparse(std::ostream& out, int indent) override;
+	DerefNode(SrcOffset offsetIn, IDNode * id)
+	: LValNode(offsetIn), myID(id){ }
 	std::string nodeKind() override { return "Deref"; }
-	virtual bool nameAnalysis(SymbolTable *) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * prog) override;
 private:
 	IDNode * myID;
@@ -138,12 +187,12 @@ private:
 
 class IndexNode : public LValNode{
 public:
-	IndexNode(size_t l, size_t c, IDNode * id, ExpNode * offset)
-	: LValNode(l, c), myBase(id), myOffset(offset){ }
-	void unparse(std::ostream& out, int indent) override;
+	IndexNode(SrcOffset offsetIn, IDNode * id, ExpNode * offset)
+	: LValNode(offsetIn), myBase(id), myOffset(offset){ }
 	std::string nodeKind() override { return "Index"; }
-	virtual bool nameAnalysis(SymbolTable * symTab) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * prog) override{
 		throw new ToDoError("Implement");
 	}
@@ -155,32 +204,30 @@ private:
 
 class TypeNode : public ASTNode{
 public:
-	TypeNode(size_t l, size_t c) : ASTNode(l, c){ }
-	void unparse(std::ostream&, int) override = 0;
+	TypeNode(SrcOffset offsetIn) : ASTNode(offsetIn){ }
 	virtual std::string nodeKind() override = 0;
-	virtual DataType * getType() = 0;
-	virtual bool nameAnalysis(SymbolTable *) override;
+	virtual DataType * getType(TypeContext * types) = 0;
 	virtual void typeAnalysis(TypeAnalysis *) = 0;
+	virtual bool nameAnalysis(NameWalker * names) override;
 };
 
 class CharTypeNode : public TypeNode{
 public:
-	CharTypeNode(size_t lIn, size_t cIn, bool isPtrIn)
-	: TypeNode(lIn, cIn), isPtr(isPtrIn){}
-	void unparse(std::ostream& out, int indent) override;
+	CharTypeNode(SrcOffset offsetIn, bool isPtrIn)
+	: TypeNode(offsetIn), isPtr(isPtrIn){}
 	std::string nodeKind() override { 
 		return "char";
 	}
-	virtual DataType * getType() override;
+	virtual DataType * getType(TypeContext * types) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 private:
 	bool isPtr;
 };
 
 class StmtNode : public ASTNode{
 public:
-	StmtNode(size_t lIn, size_t cIn) : ASTNode(lIn, cIn){ }
-	virtual void unparse(std::ostream& out, int indent) override = 0;
+	StmtNode(SrcOffset offsetIn) : ASTNode(offsetIn){ }
 	virtual std::string nodeKind() override = 0;
 	virtual void typeAnalysis(TypeAnalysis *) = 0;
 	virtual void to3AC(Procedure * proc) = 0;
@@ -188,24 +235,24 @@ public:
 
 class DeclNode : public StmtNode{
 public:
-	DeclNode(size_t l, size_t c) : StmtNode(l, c){ }
-	void unparse(std::ostream& out, int indent) override =0;
+	DeclNode(SrcOffset offsetIn) : StmtNode(offsetIn){ }
 	virtual std::string nodeKind() override = 0;
 	virtual void typeAnalysis(TypeAnalysis *) override = 0;
 	virtual void to3AC(IRProgram * prog) = 0;
 	virtual void to3AC(Procedure * proc) override = 0;
+	virtual FnDeclNode * asFnDecl(){ return nullptr; }
 };
 
 class VarDeclNode : public DeclNode{
 public:
-	VarDeclNode(size_t lIn, size_t cIn, TypeNode * typeIn, IDNode * IDIn)
-	: DeclNode(lIn, cIn), myType(typeIn), myID(IDIn){ }
-	void unparse(std::ostream& out, int indent) override;
+	VarDeclNode(SrcOffset offsetIn, TypeNode * typeIn, IDNode * IDIn)
+	: DeclNode(offsetIn), myType(typeIn), myID(IDIn){ }
 	virtual std::string nodeKind() override { return "VarDecl"; }
 	IDNode * ID(){ return myID; }
 	TypeNode * getTypeNode(){ return myType; }
-	bool nameAnalysis(SymbolTable * symTab) override;
 	void typeAnalysis(TypeAnalysis * typing) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual void to3AC(Procedure * proc) override;
 	virtual void to3AC(IRProgram * prog) override;
 protected:
@@ -215,51 +262,58 @@ protected:
 
 class FormalDeclNode : public VarDeclNode{
 public:
-	FormalDeclNode(size_t lIn, size_t cIn, TypeNode * type, IDNode * id) 
-	: VarDeclNode(lIn, cIn, type, id){ }
-	void unparse(std::ostream& out, int indent) override;
+	FormalDeclNode(SrcOffset offsetIn, TypeNode * type, IDNode * id) 
+	: VarDeclNode(offsetIn, type, id){ }
 	virtual std::string nodeKind() override { return "FormalDecl"; }
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual void to3AC(Procedure * proc) override;
 	virtual void to3AC(IRProgram * prog) override;
 };
 
 class FnDeclNode : public DeclNode{
 public:
-	FnDeclNode(size_t lIn, size_t cIn, 
+	FnDeclNode(SrcOffset offsetIn, 
 	  TypeNode * retTypeIn, IDNode * idIn,
-	  std::list<FormalDeclNode *> * formalsIn,
-	  std::list<StmtNode *> * bodyIn)
-	: DeclNode(lIn, cIn), 
+	  NodeList<FormalDeclNode *> * formalsIn,
+	  NodeList<StmtNode *> * bodyIn)
+	: DeclNode(offsetIn), 
 	  myID(idIn), myRetType(retTypeIn),
 	  myFormals(formalsIn), myBody(bodyIn){ }
 	IDNode * ID() const { return myID; }
-	std::list<FormalDeclNode *> * getFormals() const{
+	NodeList<FormalDeclNode *> * getFormals() const{
 		return myFormals;
 	}
-	void unparse(std::ostream& out, int indent) override;
+	NodeList<StmtNode *> * getBody() const { return myBody; }
 	virtual std::string nodeKind() override { return "FnDecl"; }
-	virtual bool nameAnalysis(SymbolTable * symTab) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	void to3AC(IRProgram * prog) override;
 	void to3AC(Procedure * prog) override;
+	virtual FnDeclNode * asFnDecl() override { return this; }
+	//Lowering in two steps: add the function's procedure to the
+	// program (or, if it is reused, splice it in and return
+	// nullptr), then lower the formals and body into it
+	Procedure * makeProc(IRProgram * prog);
+	void lowerBody(Procedure * proc);
 	virtual TypeNode * getRetTypeNode() { 
 		return myRetType;
 	}
 private:
 	IDNode * myID;
 	TypeNode * myRetType;
-	std::list<FormalDeclNode *> * myFormals;
-	std::list<StmtNode *> * myBody;
+	NodeList<FormalDeclNode *> * myFormals;
+	NodeList<StmtNode *> * myBody;
 };
 
 class AssignStmtNode : public StmtNode{
 public:
-	AssignStmtNode(size_t l, size_t c, AssignExpNode * expIn)
-	: StmtNode(l, c), myExp(expIn){ }
-	void unparse(std::ostream& out, int indent) override;
+	AssignStmtNode(SrcOffset offsetIn, AssignExpNode * expIn)
+	: StmtNode(offsetIn), myExp(expIn){ }
 	virtual std::string nodeKind() override { return "AssignStmt"; }
-	bool nameAnalysis(SymbolTable * symTab) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual void to3AC(Procedure * prog) override;
 private:
 	AssignExpNode * myExp;
@@ -267,12 +321,12 @@ private:
 
 class FromConsoleStmtNode : public StmtNode{
 public:
-	FromConsoleStmtNode(size_t l, size_t c, LValNode * dstIn)
-	: StmtNode(l, c), myDst(dstIn){ }
-	void unparse(std::ostream& out, int indent) override;
+	FromConsoleStmtNode(SrcOffset offsetIn, LValNode * dstIn)
+	: StmtNode(offsetIn), myDst(dstIn){ }
 	virtual std::string nodeKind() override { return "FromConsoleStmt"; }
-	bool nameAnalysis(SymbolTable * symTab) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual void to3AC(Procedure * prog) override;
 private:
 	LValNode * myDst;
@@ -280,12 +334,12 @@ private:
 
 class ToConsoleStmtNode : public StmtNode{
 public:
-	ToConsoleStmtNode(size_t l, size_t c, ExpNode * srcIn)
-	: StmtNode(l, c), mySrc(srcIn){ }
-	void unparse(std::ostream& out, int indent) override;
+	ToConsoleStmtNode(SrcOffset offsetIn, ExpNode * srcIn)
+	: StmtNode(offsetIn), mySrc(srcIn){ }
 	virtual std::string nodeKind() override { return "ToConsoleStmt"; }
-	bool nameAnalysis(SymbolTable * symTab) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual void to3AC(Procedure * prog) override;
 private:
 	ExpNode * mySrc;
@@ -293,12 +347,12 @@ private:
 
 class PostDecStmtNode : public StmtNode{
 public:
-	PostDecStmtNode(size_t l, size_t c, LValNode * lvalIn)
-	: StmtNode(l, c), myLVal(lvalIn){ }
-	void unparse(std::ostream& out, int indent) override;
+	PostDecStmtNode(SrcOffset offsetIn, LValNode * lvalIn)
+	: StmtNode(offsetIn), myLVal(lvalIn){ }
 	virtual std::string nodeKind() override { return "PostDecStmt"; }
-	virtual bool nameAnalysis(SymbolTable * symTab) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual void to3AC(Procedure * prog) override;
 private:
 	LValNode * myLVal;
@@ -306,12 +360,12 @@ private:
 
 class PostIncStmtNode : public StmtNode{
 public:
-	PostIncStmtNode(size_t l, size_t c, LValNode * lvalIn)
-	: StmtNode(l, c), myLVal(lvalIn){ }
-	void unparse(std::ostream& out, int indent) override;
+	PostIncStmtNode(SrcOffset offsetIn, LValNode * lvalIn)
+	: StmtNode(offsetIn), myLVal(lvalIn){ }
 	virtual std::string nodeKind() override { return "PostIncStmt"; }
-	virtual bool nameAnalysis(SymbolTable * symTab) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual void to3AC(Procedure * prog) override;
 private:
 	LValNode * myLVal;
@@ -319,60 +373,60 @@ private:
 
 class IfStmtNode : public StmtNode{
 public:
-	IfStmtNode(size_t l, size_t c, ExpNode * condIn,
-	  std::list<StmtNode *> * bodyIn)
-	: StmtNode(l, c), myCond(condIn), myBody(bodyIn){ }
-	void unparse(std::ostream& out, int indent) override;
+	IfStmtNode(SrcOffset offsetIn, ExpNode * condIn,
+	  NodeList<StmtNode *> * bodyIn)
+	: StmtNode(offsetIn), myCond(condIn), myBody(bodyIn){ }
 	std::string nodeKind() override { return "IfStmt"; }
-	bool nameAnalysis(SymbolTable * symTab) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual void to3AC(Procedure * prog) override;
 private:
 	ExpNode * myCond;
-	std::list<StmtNode *> * myBody;
+	NodeList<StmtNode *> * myBody;
 };
 
 class IfElseStmtNode : public StmtNode{
 public:
-	IfElseStmtNode(size_t l, size_t c, ExpNode * condIn, 
-	  std::list<StmtNode *> * bodyTrueIn,
-	  std::list<StmtNode *> * bodyFalseIn)
-	: StmtNode(l, c), myCond(condIn),
+	IfElseStmtNode(SrcOffset offsetIn, ExpNode * condIn, 
+	  NodeList<StmtNode *> * bodyTrueIn,
+	  NodeList<StmtNode *> * bodyFalseIn)
+	: StmtNode(offsetIn), myCond(condIn),
 	  myBodyTrue(bodyTrueIn), myBodyFalse(bodyFalseIn) { }
-	void unparse(std::ostream& out, int indent) override;
 	std::string nodeKind() override { return "IfElseStmt"; }
-	bool nameAnalysis(SymbolTable * symTab) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual void to3AC(Procedure * prog) override;
 private:
 	ExpNode * myCond;
-	std::list<StmtNode *> * myBodyTrue;
-	std::list<StmtNode *> * myBodyFalse;
+	NodeList<StmtNode *> * myBodyTrue;
+	NodeList<StmtNode *> * myBodyFalse;
 };
 
 class WhileStmtNode : public StmtNode{
 public:
-	WhileStmtNode(size_t l, size_t c, ExpNode * condIn, 
-	  std::list<StmtNode *> * bodyIn)
-	: StmtNode(l, c), myCond(condIn), myBody(bodyIn){ }
-	void unparse(std::ostream& out, int indent) override;
+	WhileStmtNode(SrcOffset offsetIn, ExpNode * condIn, 
+	  NodeList<StmtNode *> * bodyIn)
+	: StmtNode(offsetIn), myCond(condIn), myBody(bodyIn){ }
 	virtual std::string nodeKind() override { return "WhileStmt"; }
-	bool nameAnalysis(SymbolTable * symTab) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual void to3AC(Procedure * prog) override;
 private:
 	ExpNode * myCond;
-	std::list<StmtNode *> * myBody;
+	NodeList<StmtNode *> * myBody;
 };
 
 class ReturnStmtNode : public StmtNode{
 public:
-	ReturnStmtNode(size_t l, size_t c, ExpNode * exp)
-	: StmtNode(l, c), myExp(exp){ }
-	void unparse(std::ostream& out, int indent) override;
+	ReturnStmtNode(SrcOffset offsetIn, ExpNode * exp)
+	: StmtNode(offsetIn), myExp(exp){ }
 	virtual std::string nodeKind() override { return "ReturnStmt"; }
-	bool nameAnalysis(SymbolTable * symTab) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual void to3AC(Procedure * proc) override;
 private:
 	ExpNode * myExp;
@@ -380,27 +434,27 @@ private:
 
 class CallExpNode : public ExpNode{
 public:
-	CallExpNode(size_t l, size_t c, IDNode * id,
-	  std::list<ExpNode *> * argsIn)
-	: ExpNode(l, c), myID(id), myArgs(argsIn){ }
-	void unparse(std::ostream& out, int indent) override;
+	CallExpNode(SrcOffset offsetIn, IDNode * id,
+	  NodeList<ExpNode *> * argsIn)
+	: ExpNode(offsetIn), myID(id), myArgs(argsIn){ }
 	virtual std::string nodeKind() override { return "CallExp"; }
-	bool nameAnalysis(SymbolTable * symTab) override;
 	void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	DataType * getRetType();
 
 	virtual Opd * flatten(Procedure * proc) override;
 private:
 	IDNode * myID;
-	std::list<ExpNode *> * myArgs;
+	NodeList<ExpNode *> * myArgs;
 };
 
 class BinaryExpNode : public ExpNode{
 public:
-	BinaryExpNode(size_t lIn, size_t cIn, ExpNode * lhs, ExpNode * rhs)
-	: ExpNode(lIn, cIn), myExp1(lhs), myExp2(rhs) { }
-	bool nameAnalysis(SymbolTable * symTab) override;
+	BinaryExpNode(SrcOffset offsetIn, ExpNode * lhs, ExpNode * rhs)
+	: ExpNode(offsetIn), myExp1(lhs), myExp2(rhs) { }
 	virtual void typeAnalysis(TypeAnalysis *) override = 0;
+	virtual bool nameAnalysis(NameWalker * names) override;
 	virtual Opd * flatten(Procedure * prog) override = 0;
 protected:
 	ExpNode * myExp1;
@@ -413,137 +467,136 @@ protected:
 
 class PlusNode : public BinaryExpNode{
 public:
-	PlusNode(size_t l, size_t c, ExpNode * e1, ExpNode * e2)
-	: BinaryExpNode(l, c, e1, e2){ }
-	void unparse(std::ostream& out, int indent) override;
+	PlusNode(SrcOffset offsetIn, ExpNode * e1, ExpNode * e2)
+	: BinaryExpNode(offsetIn, e1, e2){ }
 	std::string nodeKind() override { return "Plus"; }
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * prog) override;
 };
 
 class MinusNode : public BinaryExpNode{
 public:
-	MinusNode(size_t l, size_t c, ExpNode * e1, ExpNode * e2)
-	: BinaryExpNode(l, c, e1, e2){ }
-	void unparse(std::ostream& out, int indent) override;
+	MinusNode(SrcOffset offsetIn, ExpNode * e1, ExpNode * e2)
+	: BinaryExpNode(offsetIn, e1, e2){ }
 	std::string nodeKind() override { return "Minus"; }
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * prog) override;
 };
 
 class TimesNode : public BinaryExpNode{
 public:
-	TimesNode(size_t l, size_t c, ExpNode * e1In, ExpNode * e2In)
-	: BinaryExpNode(l, c, e1In, e2In){ }
-	void unparse(std::ostream& out, int indent) override;
+	TimesNode(SrcOffset offsetIn, ExpNode * e1In, ExpNode * e2In)
+	: BinaryExpNode(offsetIn, e1In, e2In){ }
 	std::string nodeKind() override { return "Times"; }
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * prog) override;
 };
 
 class DivideNode : public BinaryExpNode{
 public:
-	DivideNode(size_t lIn, size_t cIn, ExpNode * e1, ExpNode * e2)
-	: BinaryExpNode(lIn, cIn, e1, e2){ }
-	void unparse(std::ostream& out, int indent) override;
+	DivideNode(SrcOffset offsetIn, ExpNode * e1, ExpNode * e2)
+	: BinaryExpNode(offsetIn, e1, e2){ }
 	std::string nodeKind() override { return "Divide"; }
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * prog) override;
 };
 
 class AndNode : public BinaryExpNode{
 public:
-	AndNode(size_t l, size_t c, ExpNode * e1, ExpNode * e2)
-	: BinaryExpNode(l, c, e1, e2){ }
-	void unparse(std::ostream& out, int indent) override;
+	AndNode(SrcOffset offsetIn, ExpNode * e1, ExpNode * e2)
+	: BinaryExpNode(offsetIn, e1, e2){ }
 	std::string nodeKind() override { return "And"; }
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * prog) override;
 };
 
 class OrNode : public BinaryExpNode{
 public:
-	OrNode(size_t l, size_t c, ExpNode * e1, ExpNode * e2)
-	: BinaryExpNode(l, c, e1, e2){ }
-	void unparse(std::ostream& out, int indent) override;
+	OrNode(SrcOffset offsetIn, ExpNode * e1, ExpNode * e2)
+	: BinaryExpNode(offsetIn, e1, e2){ }
 	std::string nodeKind() override { return "Or"; }
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * prog) override;
 };
 
 class EqualsNode : public BinaryExpNode{
 public:
-	EqualsNode(size_t l, size_t c, ExpNode * e1, ExpNode * e2)
-	: BinaryExpNode(l, c, e1, e2){ }
-	void unparse(std::ostream& out, int indent) override;
+	EqualsNode(SrcOffset offsetIn, ExpNode * e1, ExpNode * e2)
+	: BinaryExpNode(offsetIn, e1, e2){ }
 	std::string nodeKind() override { return "Eq"; }
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * prog) override;
 	
 };
 
 class NotEqualsNode : public BinaryExpNode{
 public:
-	NotEqualsNode(size_t l, size_t c, ExpNode * e1, ExpNode * e2)
-	: BinaryExpNode(l, c, e1, e2){ }
-	void unparse(std::ostream& out, int indent) override;
+	NotEqualsNode(SrcOffset offsetIn, ExpNode * e1, ExpNode * e2)
+	: BinaryExpNode(offsetIn, e1, e2){ }
 	std::string nodeKind() override { return "NotEq"; }
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * prog) override;
 	
 };
 
 class LessNode : public BinaryExpNode{
 public:
-	LessNode(size_t lineIn, size_t colIn, 
+	LessNode(SrcOffset offsetIn, 
 		ExpNode * exp1, ExpNode * exp2)
-	: BinaryExpNode(lineIn, colIn, exp1, exp2){ }
-	void unparse(std::ostream& out, int indent) override;
+	: BinaryExpNode(offsetIn, exp1, exp2){ }
 	std::string nodeKind() override { return "Less"; }
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * proc) override;
 };
 
 class LessEqNode : public BinaryExpNode{
 public:
-	LessEqNode(size_t l, size_t c, ExpNode * e1, ExpNode * e2)
-	: BinaryExpNode(l, c, e1, e2){ }
-	void unparse(std::ostream& out, int indent) override;
+	LessEqNode(SrcOffset offsetIn, ExpNode * e1, ExpNode * e2)
+	: BinaryExpNode(offsetIn, e1, e2){ }
 	std::string nodeKind() override { return "LessEq"; }
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * prog) override;
 };
 
 class GreaterNode : public BinaryExpNode{
 public:
-	GreaterNode(size_t lineIn, size_t colIn, 
+	GreaterNode(SrcOffset offsetIn, 
 		ExpNode * exp1, ExpNode * exp2)
-	: BinaryExpNode(lineIn, colIn, exp1, exp2){ }
-	void unparse(std::ostream& out, int indent) override;
+	: BinaryExpNode(offsetIn, exp1, exp2){ }
 	std::string nodeKind() override { return "GreaterEq"; }
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * proc) override;
 };
 
 class GreaterEqNode : public BinaryExpNode{
 public:
-	GreaterEqNode(size_t l, size_t c, ExpNode * e1, ExpNode * e2)
-	: BinaryExpNode(l, c, e1, e2){ }
-	void unparse(std::ostream& out, int indent) override;
+	GreaterEqNode(SrcOffset offsetIn, ExpNode * e1, ExpNode * e2)
+	: BinaryExpNode(offsetIn, e1, e2){ }
 	std::string nodeKind() override { return "GreaterEq"; }
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * prog) override;
 };
 
 class UnaryExpNode : public ExpNode {
 public:
-	UnaryExpNode(size_t lIn, size_t cIn, ExpNode * expIn) 
-	: ExpNode(lIn, cIn){
+	UnaryExpNode(SrcOffset offsetIn, ExpNode * expIn) 
+	: ExpNode(offsetIn){
 		this->myExp = expIn;
 	}
-	virtual void unparse(std::ostream& out, int indent) override = 0;
-	virtual bool nameAnalysis(SymbolTable * symTab) override = 0;
 	virtual void typeAnalysis(TypeAnalysis *) override = 0;
+	virtual bool nameAnalysis(NameWalker * names) override;
 	virtual Opd * flatten(Procedure * prog) override = 0;
 protected:
 	ExpNode * myExp;
@@ -551,55 +604,53 @@ protected:
 
 class NegNode : public UnaryExpNode{
 public:
-	NegNode(size_t l, size_t c, ExpNode * exp)
-	: UnaryExpNode(l, c, exp){ }
-	void unparse(std::ostream& out, int indent) override;
+	NegNode(SrcOffset offsetIn, ExpNode * exp)
+	: UnaryExpNode(offsetIn, exp){ }
 	std::string nodeKind() override { return "Neg"; }
-	bool nameAnalysis(SymbolTable * symTab) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * prog) override;
 };
 
 class NotNode : public UnaryExpNode{
 public:
-	NotNode(size_t lIn, size_t cIn, ExpNode * exp)
-	: UnaryExpNode(lIn, cIn, exp){ }
-	void unparse(std::ostream& out, int indent) override;
+	NotNode(SrcOffset offsetIn, ExpNode * exp)
+	: UnaryExpNode(offsetIn, exp){ }
 	std::string nodeKind() override { return "Not"; }
-	bool nameAnalysis(SymbolTable * symTab) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * prog) override;
 };
 
 class VoidTypeNode : public TypeNode{
 public:
-	VoidTypeNode(size_t l, size_t c) : TypeNode(l, c){}
-	void unparse(std::ostream& out, int indent) override;
+	VoidTypeNode(SrcOffset offsetIn) : TypeNode(offsetIn){}
 	virtual std::string nodeKind() override { return "VoidType"; }
-	virtual DataType * getType()override { 
-		return BasicType::VOID(); 
+	virtual DataType * getType(TypeContext * types) override { 
+		return types->VOID(); 
 	}
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 };
 
 class IntTypeNode : public TypeNode{
 public:
-	IntTypeNode(size_t l, size_t c, bool ptrIn): TypeNode(l, c), isPtr(ptrIn){}
-	void unparse(std::ostream& out, int indent) override;
+	IntTypeNode(SrcOffset offsetIn, bool ptrIn): TypeNode(offsetIn), isPtr(ptrIn){}
 	virtual std::string nodeKind() override { return "IntType"; }
-	virtual DataType * getType() override;
+	virtual DataType * getType(TypeContext * types) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 private:
 	const bool isPtr;
 };
 
 class BoolTypeNode : public TypeNode{
 public:
-	BoolTypeNode(size_t l, size_t c, bool ptrIn): TypeNode(l, c), isPtr(ptrIn) { }
-	void unparse(std::ostream& out, int indent) override;
+	BoolTypeNode(SrcOffset offsetIn, bool ptrIn): TypeNode(offsetIn), isPtr(ptrIn) { }
 	virtual std::string nodeKind() override { return "BoolType"; }
-	virtual DataType * getType() override;
+	virtual DataType * getType(TypeContext * types) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 private:
 	const bool isPtr;
 };
@@ -607,12 +658,12 @@ private:
 
 class AssignExpNode : public ExpNode{
 public:
-	AssignExpNode(size_t l, size_t c, LValNode * dstIn, ExpNode * srcIn)
-	: ExpNode(l, c), myDst(dstIn), mySrc(srcIn){ }
-	void unparse(std::ostream& out, int indent) override;
+	AssignExpNode(SrcOffset offsetIn, LValNode * dstIn, ExpNode * srcIn)
+	: ExpNode(offsetIn), myDst(dstIn), mySrc(srcIn){ }
 	virtual std::string nodeKind() override { return "AssignExp"; }
-	bool nameAnalysis(SymbolTable * symTab) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * proc) override;
 private:
 	LValNode * myDst;
@@ -621,15 +672,15 @@ private:
 
 class IntLitNode : public ExpNode{
 public:
-	IntLitNode(size_t l, size_t c, const int numIn)
-	: ExpNode(l, c), myNum(numIn){ }
+	IntLitNode(SrcOffset offsetIn, const int numIn)
+	: ExpNode(offsetIn), myNum(numIn){ }
+	virtual std::string nodeKind() override { return "IntLit"; }
 	virtual void unparseNested(std::ostream& out) override{
 		unparse(out, 0);
 	}
-	void unparse(std::ostream& out, int indent) override;
-	virtual std::string nodeKind() override { return "IntLit"; }
-	bool nameAnalysis(SymbolTable * symTab) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * prog) override;
 private:
 	const int myNum;
@@ -637,15 +688,15 @@ private:
 
 class StrLitNode : public ExpNode{
 public:
-	StrLitNode(size_t l, size_t c, const std::string strIn)
-	: ExpNode(l, c), myStr(strIn){ }
+	StrLitNode(SrcOffset offsetIn, TextView strIn)
+	: ExpNode(offsetIn), myStr(strIn.str()){ }
+	virtual std::string nodeKind() override { return "StrLit"; }
 	virtual void unparseNested(std::ostream& out) override{
 		unparse(out, 0);
 	}
-	void unparse(std::ostream& out, int indent) override;
-	virtual std::string nodeKind() override { return "StrLit"; }
-	bool nameAnalysis(SymbolTable *) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * proc) override;
 private:
 	 const std::string myStr;
@@ -653,15 +704,15 @@ private:
 
 class CharLitNode : public ExpNode{
 public:
-	CharLitNode(size_t l, size_t c, const char valIn)
-	: ExpNode(l, c), myVal(valIn){ }
+	CharLitNode(SrcOffset offsetIn, const char valIn)
+	: ExpNode(offsetIn), myVal(valIn){ }
+	virtual std::string nodeKind() override { return "CharLit"; }
 	virtual void unparseNested(std::ostream& out) override{
 		unparse(out, 0);
 	}
-	void unparse(std::ostream& out, int indent) override;
-	virtual std::string nodeKind() override { return "CharLit"; }
-	bool nameAnalysis(SymbolTable *) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * proc) override;
 private:
 	 const char myVal;
@@ -669,51 +720,51 @@ private:
 
 class NullPtrNode : public ExpNode{
 public:
-	NullPtrNode(size_t l, size_t c): ExpNode(l, c){ }
+	NullPtrNode(SrcOffset offsetIn): ExpNode(offsetIn){ }
+	virtual std::string nodeKind() override { return "NullPtr"; }
 	virtual void unparseNested(std::ostream& out) override{
 		unparse(out, 0);
 	}
-	void unparse(std::ostream& out, int indent) override;
-	virtual std::string nodeKind() override { return "NullPtr"; }
-	bool nameAnalysis(SymbolTable *) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * proc) override;
 };
 
 class TrueNode : public ExpNode{
 public:
-	TrueNode(size_t l, size_t c): ExpNode(l, c){ }
+	TrueNode(SrcOffset offsetIn): ExpNode(offsetIn){ }
+	virtual std::string nodeKind() override { return "True"; }
 	virtual void unparseNested(std::ostream& out) override{
 		unparse(out, 0);
 	}
-	void unparse(std::ostream& out, int indent) override;
-	virtual std::string nodeKind() override { return "True"; }
-	bool nameAnalysis(SymbolTable * symTab) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * prog) override;
 };
 
 class FalseNode : public ExpNode{
 public:
-	FalseNode(size_t l, size_t c): ExpNode(l, c){ }
+	FalseNode(SrcOffset offsetIn): ExpNode(offsetIn){ }
+	virtual std::string nodeKind() override { return "False"; }
 	virtual void unparseNested(std::ostream& out) override{
 		unparse(out, 0);
 	}
-	void unparse(std::ostream& out, int indent) override;
-	virtual std::string nodeKind() override { return "False"; }
-	bool nameAnalysis(SymbolTable * symTab) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual Opd * flatten(Procedure * prog) override;
 };
 
 class CallStmtNode : public StmtNode{
 public:
-	CallStmtNode(size_t l, size_t c, CallExpNode * expIn)
-	: StmtNode(l, c), myCallExp(expIn){ }
-	void unparse(std::ostream& out, int indent) override;
+	CallStmtNode(SrcOffset offsetIn, CallExpNode * expIn)
+	: StmtNode(offsetIn), myCallExp(expIn){ }
 	std::string nodeKind() override { return "CallStmt"; }
-	bool nameAnalysis(SymbolTable * symTab) override;
 	virtual void typeAnalysis(TypeAnalysis *) override;
+	virtual bool nameAnalysis(NameWalker * names) override;
+	virtual void unparse(std::ostream& out, int indent) override;
 	virtual void to3AC(Procedure * proc) override;
 private:
 	CallExpNode * myCallExp;
@@ -0,0 +1,84 @@
+#ifndef HOLEYC_AST_BUILDER_HPP
+#define HOLEYC_AST_BUILDER_HPP
+
+#include <utility>
+#include <vector>
+#include "arena.hpp"
+#include "ast.hpp"
+
+namespace holeyc{
+
+//Takes each top-level declaration as soon as it is parsed, for
+// compiling a program one declaration at a time
+class DeclSink{
+public:
+	virtual ~DeclSink(){ }
+	//The nodes of decl are numbered from 0 up to nodeCount. All
+	// of them are freed once this returns.
+	virtual void topLevel(DeclNode * decl, size_t nodeCount) = 0;
+};
+
+//Creates the nodes of a single AST. Nodes and their child 
+// lists are bump-allocated out of the given arena, in the 
+// order the parser reduces them, so a subtree ends up packed
+// together in memory; the whole tree is freed with the arena.
+// Every node built through here gets the next dense node ID,
+// so that once the tree is done nodeCount() is the size of a 
+// NodeTable covering it. The ID nodes are also listed in the
+// order they were built, which is the order they appear in the
+// source.
+//Given a DeclSink, the builder hands it each top-level
+// declaration instead of adding it to the program, and then
+// starts over with an empty arena and node IDs. The
+// program node ends up with no globals.
+class ASTBuilder{
+public:
+	ASTBuilder(Arena * arenaIn) : myArena(arenaIn), myNextID(0){ }
+	template <typename T, typename... Args>
+	T * make(const Args&... args){
+		T * node = myArena->make<T>(args...);
+		node->myNodeID = myNextID++;
+		noteNode(node);
+		return node;
+	}
+	template <typename T>
+	NodeList<T> * makeList(){
+		return myArena->make<NodeList<T>>(ArenaAllocator<T>(myArena));
+	}
+	size_t nodeCount() const { return myNextID; }
+	const std::vector<IDNode *>& idNodes() const { return myIDNodes; }
+
+	void setDeclSink(DeclSink * sinkIn){ mySink = sinkIn; }
+	//The list the top-level declarations are gathered in. When
+	// there is a sink, it has to outlive every declaration, so
+	// it is kept out of the arena
+	NodeList<DeclNode *> * makeGlobals(){
+		if (mySink == nullptr){ return makeList<DeclNode *>(); }
+		return myStreamArena.make<NodeList<DeclNode *>>(
+		  ArenaAllocator<DeclNode *>(&myStreamArena));
+	}
+	//Called as each top-level declaration is reduced. True if
+	// a sink took it (and it is gone), false if it should be
+	// added to the program as usual
+	bool topLevel(DeclNode * decl){
+		if (mySink == nullptr){ return false; }
+		mySink->topLevel(decl, myNextID);
+		myArena->reset();
+		myNextID = 0;
+		myIDNodes.clear();
+		return true;
+	}
+private:
+	void noteNode(IDNode * id){ myIDNodes.push_back(id); }
+	void noteNode(ASTNode *){ }
+
+	Arena * myArena;
+	NodeID myNextID;
+	std::vector<IDNode *> myIDNodes;
+	DeclSink * mySink = nullptr;
+	Arena myStreamArena{1024};
+};
+
+}
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef HOLEYC_CACHE_HPP
+#define HOLEYC_CACHE_HPP
+
+#include <cstdint>
+#include <string>
+
+namespace holeyc{
+
+//An on-disk cache of rendered 3AC programs, addressed by the
+// content of what produced them: the source bytes, the options
+// they were compiled with and the compiler that compiled them.
+// An input that is byte-for-byte the same as one compiled
+// before, under the same options and compiler, gets its 3AC
+// copied out of the cache instead of being compiled again.
+// Entries are written whole under a temporary name and renamed
+// into place, so any number of processes can share a cache
+// directory, and a missing or unreadable entry is just a miss.
+class OutputCache{
+public:
+	OutputCache(const std::string& dirIn) : dir(dirIn){ }
+
+	//The key for the given input and options. The compiler is
+	// identified by the size and modification time of the
+	// running executable, along with CACHE_FORMAT below
+	static std::string key(const char * data, size_t size,
+	  const std::string& options);
+
+	//True, with the stored text in out, on a hit. Each kind of
+	// entry is kept under its own extension
+	bool lookup(const std::string& keyIn, std::string& out,
+	  const char * ext = ".3ac") const;
+	//Best effort: failing to store an entry is not an error
+	void store(const std::string& keyIn, const std::string& text,
+	  const char * ext = ".3ac") const;
+private:
+	std::string pathOf(const std::string& keyIn, const char * ext) const;
+	std::string dir;
+};
+
+//Two 64-bit FNV-1a lanes with different starting points, fed
+// the same bytes, for a 128-bit digest
+class Digest{
+public:
+	void add(const char * data, size_t size){
+		for (size_t i = 0; i < size; i++){
+			unsigned char byte = static_cast<unsigned char>(data[i]);
+			lo = (lo ^ byte) * PRIME;
+			hi = (hi ^ byte ^ 0x5c) * PRIME;
+		}
+	}
+	void add(const std::string& str){
+		//The length keeps adjacent fields from running together
+		uint64_t len = str.size();
+		add(reinterpret_cast<const char *>(&len), sizeof(len));
+		add(str.data(), str.size());
+	}
+	std::string hex() const {
+		static const char * const digits = "0123456789abcdef";
+		std::string res;
+		for (uint64_t lane : {hi, lo}){
+			for (int shift = 60; shift >= 0; shift -= 4){
+				res += digits[(lane >> shift) & 0xf];
+			}
+		}
+		return res;
+	}
+private:
+	static const uint64_t PRIME = 1099511628211ull;
+	uint64_t lo = 14695981039346656037ull;
+	uint64_t hi = 0x84222325cbf29ce4ull;
+};
+
+//What identifies the compiler: the cache format and a checksum
+// of the sources it was built from, compiled into the library.
+// Every build of the same sources shares a cache, however and
+// wherever it is installed or embedded
+const std::string& compilerID();
+
+//Bump whenever the 3AC rendering of a program changes without
+// the sources changing with it
+static const char * const CACHE_FORMAT = "holeycc-3ac-1";
+
+}
+
+#endif
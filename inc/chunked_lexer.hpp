@@ -0,0 +1,50 @@
+#ifndef HOLEYC_CHUNKED_LEXER_HPP
+#define HOLEYC_CHUNKED_LEXER_HPP
+
+#include <memory>
+#include <vector>
+#include "arena.hpp"
+#include "context.hpp"
+#include "token_stream.hpp"
+
+namespace holeyc{
+
+//Lexes a large input on several threads at once. No match of
+// the scanner runs on past a newline (strings, character
+// literals and comments all end at one), so the input can be
+// cut just after any newline and the pieces lexed on their
+// own. Offsets are into the whole input, so lines and columns
+// come out right without fixing anything up; what does need
+// putting back in order is the rest of the shared state. Each
+// piece interns its names and records its errors privately,
+// and once all are lexed the names are interned and the errors
+// gathered piece by piece, in input order, which hands out the
+// same name IDs and gives the same errors, found lexing the same
+// tokens, as lexing the input in one go would.
+class ChunkedLexer{
+public:
+	ChunkedLexer(CompilationContext * ctxIn, size_t threadsIn);
+	~ChunkedLexer();
+
+	//Whether an input of this size is worth lexing in pieces
+	static bool splits(size_t inputSize);
+
+	//As Lexer::lexAll(). The tokens of each piece are made in
+	// an arena of its own, kept until this is destroyed; the
+	// END token, and all of them if the input is too small to be
+	// worth splitting, are made in tokenArena
+	void lexAll(std::vector<LexedToken>& tokens, Arena * tokenArena,
+	  LexErrors& errors);
+private:
+	ChunkedLexer(const ChunkedLexer&) = delete;
+	ChunkedLexer& operator=(const ChunkedLexer&) = delete;
+
+	struct Chunk;
+	CompilationContext * ctx;
+	size_t threads;
+	std::vector<std::unique_ptr<Chunk>> chunks;
+};
+
+}
+
+#endif
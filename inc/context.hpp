@@ -0,0 +1,88 @@
+#ifndef HOLEYC_CONTEXT_HPP
+#define HOLEYC_CONTEXT_HPP
+
+#include <iostream>
+#include <memory>
+#include "arena.hpp"
+#include "errors.hpp"
+#include "interner.hpp"
+#include "source.hpp"
+#include "types.hpp"
+
+namespace holeyc{
+
+//Which scanner turns the input into tokens: the hand-written
+// FastScanner or the Scanner flex generates from holeyc.l.
+// Both make the same tokens and report the same errors.
+// Flex is the default; building with HOLEYC_HAND_LEXER defined
+// makes it the hand-written one.
+enum class LexerKind{ HAND, FLEX };
+#ifdef HOLEYC_HAND_LEXER
+static const LexerKind DEFAULT_LEXER = LexerKind::HAND;
+#else
+static const LexerKind DEFAULT_LEXER = LexerKind::FLEX;
+#endif
+
+//What a long-lived compiler keeps from one compilation to the
+// next: the interned names and the types, which the next input
+// mostly asks for again, and the arenas, whose memory is handed
+// back out instead of going back to the system allocator. Only
+// one compilation may use it at a time.
+class ResidentState{
+public:
+	ResidentState(){ }
+	StringInterner names;
+	TypeContext types;
+	Arena tokenArena;
+	Arena astArena;
+private:
+	ResidentState(const ResidentState&) = delete;
+	ResidentState& operator=(const ResidentState&) = delete;
+};
+
+//Everything a single compilation shares between its phases:
+// the interned names, the type tables and the diagnostic sink.
+// None of it is global or static, so compilations with their
+// own contexts can run on separate threads without locking.
+// The names and types are the context's own unless it is
+// given a ResidentState to take them from.
+class CompilationContext{
+public:
+	CompilationContext(std::ostream& diagOut = std::cerr,
+	  std::ostream& msgOut = std::cout,
+	  ResidentState * resident = nullptr)
+	: ownNames(resident ? nullptr : new StringInterner()),
+	  ownTypes(resident ? nullptr : new TypeContext()),
+	  names(resident ? resident->names : *ownNames),
+	  types(resident ? resident->types : *ownTypes),
+	  diags(diagOut, msgOut){ }
+
+	//The input being compiled; diagnostics given as source
+	// offsets are resolved against it
+	void setSource(const SourceManager * sourceIn){
+		mySource = sourceIn;
+		diags.setSource(sourceIn);
+	}
+	const SourceManager * source() const { return mySource; }
+
+private:
+	std::unique_ptr<StringInterner> ownNames;
+	std::unique_ptr<TypeContext> ownTypes;
+public:
+	//Every identifier in the compilation, interned once by the
+	// scanner and compared by ID from then on
+	StringInterner& names;
+	//Every type in the compilation
+	TypeContext& types;
+	Diagnostics diags;
+	//Which scanner lexes the input
+	LexerKind lexer = DEFAULT_LEXER;
+private:
+	CompilationContext(const CompilationContext&) = delete;
+	CompilationContext& operator=(const CompilationContext&) = delete;
+	const SourceManager * mySource = nullptr;
+};
+
+}
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef HOLEYC_DRIVER_HPP
+#define HOLEYC_DRIVER_HPP
+
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "session.hpp"
+
+namespace holeyc{
+
+//The outputs requested for a single input. A null path means
+// the output was not requested; a path of "--" means stdout.
+struct DriverOptions{
+	const char * tokensFile = nullptr;
+	//The tokens again, as a TokenFile
+	const char * tokenFileOut = nullptr;
+	//If set, the tokens are read from this TokenFile instead of
+	// lexing the input
+	const char * tokenFileIn = nullptr;
+	bool checkParse = false;
+	const char * unparseFile = nullptr;
+	const char * nameFile = nullptr;
+	bool checkTypes = false;
+	const char * threeACFile = nullptr;
+	//If set, the 3AC is looked up in and stored to an
+	// OutputCache in this directory
+	const char * cacheDir = nullptr;
+	//If set, and types are checked or 3AC asked for (and no
+	// output that needs the whole AST is), compile the input
+	// one declaration at a time with a StreamCompiler. The
+	// cache is not used.
+	bool stream = false;
+	//Threads to lex, analyze and lower the functions on, 0
+	// picking one per hardware thread. Not used when streaming.
+	size_t threads = 1;
+	//Which scanner lexes the input
+	LexerKind lexer = DEFAULT_LEXER;
+};
+
+//Whether a run with these options can be answered from the
+// cache: only if all it asks for is the 3AC (checking the parse
+// or the types along the way, which a cached run passed)
+bool cacheable(const DriverOptions& opts);
+//The options that go into a cache key
+std::string cacheOptions(const DriverOptions& opts);
+
+//Where the outputs of a session go. This one writes each to
+// the file it names, or to stdout for "--".
+class OutputFiles{
+public:
+	virtual ~OutputFiles(){ }
+	//The stream to write the output named by path to, or
+	// nullptr if it can't be written. The stream stays valid
+	// until the next call.
+	virtual std::ostream * open(const char * path);
+private:
+	std::ofstream file;
+};
+
+//Serve every requested output from the given session, writing
+// the driver's own messages to err. Returns the exit status
+// for the input (0 on success).
+int runSession(CompilationSession * session,
+  const DriverOptions& opts, std::ostream& err);
+//As above, but with the outputs going wherever outputs puts
+// them
+int runSession(CompilationSession * session,
+  const DriverOptions& opts, std::ostream& err, OutputFiles& outputs);
+
+//The outputs requested for every input of a batch. Each one is
+// written next to its input, with the input's extension
+// replaced: .tokens, .unparse, .names and .3ac. Diagnostics go
+// to a .err file the same way.
+struct BatchOptions{
+	bool tokens = false;
+	bool checkParse = false;
+	bool unparse = false;
+	bool names = false;
+	bool checkTypes = false;
+	bool threeAC = false;
+	//As for DriverOptions
+	const char * cacheDir = nullptr;
+	bool stream = false;
+	LexerKind lexer = DEFAULT_LEXER;
+	//Worker threads to use; 0 picks one per hardware thread
+	size_t threads = 0;
+};
+
+//Compile each input in its own session on a pool of worker
+// threads. Sessions share nothing, so the inputs are compiled
+// independently of each other and of the order they finish
+// in. Inputs that failed are listed on stderr, in input order.
+// Returns 0 if every input succeeded.
+int runBatch(const std::vector<std::string>& inputs,
+  const BatchOptions& opts);
+
+}
+
+#endif
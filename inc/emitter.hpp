@@ -0,0 +1,61 @@
+#ifndef HOLEYC_EMITTER_HPP
+#define HOLEYC_EMITTER_HPP
+
+#include <cstring>
+#include <ostream>
+#include <string>
+
+namespace holeyc{
+
+//Where rendered 3AC goes. Text is appended to a buffer, which
+// for a stream is written out whenever it fills up, so a whole
+// program is written a buffer at a time without ever being held
+// in memory. Numbers are written digit by digit straight into
+// the buffer rather than through temporary strings.
+class Emitter{
+public:
+	//Write to out, a buffer at a time
+	explicit Emitter(std::ostream& outIn);
+	//Append to str
+	explicit Emitter(std::string& strIn);
+	~Emitter(){ flush(); }
+
+	void put(const char * data, size_t len){
+		buf->append(data, len);
+		if (out != nullptr && buf->size() >= FLUSH_AT){ flush(); }
+	}
+	void putNum(unsigned long long num);
+	void putInt(long long num);
+	//Write anything buffered through to the stream (if any)
+	void flush();
+
+	Emitter& operator<<(char c){
+		put(&c, 1);
+		return *this;
+	}
+	Emitter& operator<<(const char * text){
+		put(text, strlen(text));
+		return *this;
+	}
+	Emitter& operator<<(const std::string& text){
+		put(text.data(), text.size());
+		return *this;
+	}
+	Emitter& operator<<(size_t num){
+		putNum(num);
+		return *this;
+	}
+private:
+	Emitter(const Emitter&) = delete;
+	Emitter& operator=(const Emitter&) = delete;
+
+	static const size_t FLUSH_AT = 64 * 1024;
+	std::ostream * out;
+	std::string ownBuf;
+	//ownBuf for a stream, the caller's string otherwise
+	std::string * buf;
+};
+
+}
+
+#endif
@@ -6,28 +6,12 @@
 #define CODELOC __FILE__ ":" EXPAND1(__LINE__) " - "
 #define TODO(x) throw new ToDoError(CODELOC #x);
 
-#include <iostream>
+#include <string>
 
+//Problems with the input are reported through a compilation's
+// Diagnostics (see errors.hpp), never printed from here
 namespace lake{
 
-class Err{
-	public:
-	static void report(const std::string msg){ 
-		std::cerr << msg << std::endl;
-	}
-	static void semanticReport(
-		size_t line, 
-		size_t col, 
-		const std::string msg
-	){
-		std::cerr << line << "," << col 
-			<< ": " << msg << std::endl;
-	}
-	static void syntaxReport(const std::string msg){
-		lake::Err::report(" ***ERROR*** " + msg);
-	}
-};
-
 class InternalError{
 public:
 	InternalError(const char * msgIn){ msg = msgIn; }
@@ -7,16 +7,16 @@ namespace holeyc{
 
 class NameErr{
 public:
-static bool undeclID(size_t line, size_t col){
-	Report::fatal(line, col, "Undeclared identifier");
+static bool undeclID(Diagnostics& diags, SrcOffset at){
+	diags.fatal(at, "Undeclared identifier");
 	return false;
 }
-static bool badVarType(size_t line, size_t col){
-	Report::fatal(line, col, "Invalid type in declaration");
+static bool badVarType(Diagnostics& diags, SrcOffset at){
+	diags.fatal(at, "Invalid type in declaration");
 	return false;
 }
-static bool multiDecl(size_t line, size_t col){
-	Report::fatal(line, col, "Multiply declared identifier");
+static bool multiDecl(Diagnostics& diags, SrcOffset at){
+	diags.fatal(at, "Multiply declared identifier");
 	return false;
 }
 };
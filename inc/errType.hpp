@@ -7,97 +7,97 @@ namespace holeyc{
 
 class TypeErr {
 public:
-static void writeFn(size_t line, size_t col){
-	Report::fatal(line, col, "Attempt to write a function");
+static void writeFn(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, "Attempt to write a function");
 }
-static void writePtr(size_t line, size_t col){
-	Report::fatal(line, col, 
+static void writePtr(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, 
 	  "Attempt to write a raw pointer");
 }
-static void writeVoid(size_t line, size_t col){
-	Report::fatal(line, col, 
+static void writeVoid(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, 
 	  "Attempt to write void");
 }
-static void readFn(size_t line, size_t col){
-	Report::fatal(line, col, 
+static void readFn(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, 
 	  "Attempt to read a function");
 }
-static void readPtr(size_t line, size_t col){
-	Report::fatal(line, col, 
+static void readPtr(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, 
 	  "Attempt to read an array variable");
 }
-static void callNonFn(size_t line, size_t col){
-	Report::fatal(line, col, 
+static void callNonFn(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, 
 	  "Attempt to call a non-function");
 }
-static void badArgCount(size_t line, size_t col){
-	Report::fatal(line, col, 
+static void badArgCount(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, 
 	  "Function call with wrong number of args");
 }
-static void badArgType(size_t line, size_t col){
-	Report::fatal(line, col, 
+static void badArgType(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, 
 	  "Type of actual does not match type of formal");
 }
-static bool missRetValue(size_t line, size_t col){
-	Report::fatal(line, col, 
+static bool missRetValue(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, 
 	  "Missing return value");
 	return false;
 }
-static bool extraRetValue(size_t line, size_t col){
-	Report::fatal(line, col, 
+static bool extraRetValue(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, 
 	  "Return with a value in void function");
 	return false;
 }
-static void badRetValue(size_t line, size_t col){
-	Report::fatal(line, col, 
+static void badRetValue(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, 
 	  "Bad return value");
 }
-static void badMath(size_t line, size_t col){
-	Report::fatal(line, col, 
+static void badMath(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, 
 	  "Arithmetic operator applied to non-numeric operand");
 }
-static void badRelation(size_t line, size_t col){
-	Report::fatal(line, col, 
+static void badRelation(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, 
 	  "Relational operator applied to non-numeric operand");
 }
-static void badLogic(size_t line, size_t col){
-	Report::fatal(line, col, 
+static void badLogic(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, 
 	  "Logical operator applied to non-bool operand");
 }
-static void badIf(size_t line, size_t col){
-	Report::fatal(line, col, 
+static void badIf(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, 
 	  "Non-bool expression used as an if condition");
 }
-static void badWhile(size_t line, size_t col){
-	Report::fatal(line, col, 
+static void badWhile(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, 
 	  "Non-bool expression used as a while condition");
 }
-static void mismatch(size_t line, size_t col){
-	Report::fatal(line, col, "Type mismatch");
+static void mismatch(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, "Type mismatch");
 }
-static void voidEq(size_t line, size_t col){
-	Report::fatal(line, col, 
+static void voidEq(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, 
 		"Equality operator applied" " to void functions");
 }
-static void fnEq(size_t line, size_t col){
-	Report::fatal(line, col, 
+static void fnEq(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, 
 		"Equality operator applied to functions");
 }
-static void arrEq(size_t line, size_t col){
-	Report::fatal(line, col, 
+static void arrEq(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, 
 		"Equality operator applied to arrays");
 }
-static void fnAssign(size_t line, size_t col){
-	Report::fatal(line, col, "Function assignment");
+static void fnAssign(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, "Function assignment");
 }
-static void arrAssign(size_t line, size_t col){
-	Report::fatal(line, col, "Array variable assignment");
+static void arrAssign(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, "Array variable assignment");
 }
-static void badDeref(size_t line, size_t col){
-	Report::fatal(line, col, "Invalid operand for dereference");
+static void badDeref(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, "Invalid operand for dereference");
 }
-static void badVoid(size_t line, size_t col){
-	Report::fatal(line, col, "Invalid type in declaration");
+static void badVoid(Diagnostics& diags, size_t line, size_t col){
+	diags.fatal(line, col, "Invalid type in declaration");
 }
 
 };
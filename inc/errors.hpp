@@ -7,6 +7,9 @@
 #define TODO(x) throw new ToDoError(CODELOC #x);
 
 #include <iostream>
+#include <string>
+#include <vector>
+#include "source.hpp"
 
 namespace holeyc{
 
@@ -26,18 +29,58 @@ private:
 	const char * myMsg;
 };
 
-class Report{
+//A single problem reported by a compilation. Positions count
+// from 1; problems not tied to a place in the input (such as
+// internal errors) have a line and column of 0.
+struct Diagnostic{
+	enum Severity { FATAL, SYNTAX, WARNING, INTERNAL };
+	Severity severity;
+	size_t line;
+	size_t col;
+	std::string message;
+};
+
+//The diagnostic sink of a single compilation. Everything the
+// compilation reports goes through here to the streams it was
+// given (for the command line, errors to std::cerr and
+// informational output, such as the parser's detailed syntax
+// error messages, to std::cout), and is also kept as a list of
+// Diagnostics for callers that want them structured. Nothing
+// is shared between sinks, so compilations running side by
+// side each report through their own.
+//A sink made without streams only records what it is given,
+// to be replayed into another sink later: that is how work
+// done in parallel within a compilation reports its problems
+// in the same order a serial run would.
+class Diagnostics{
 public:
-	static void fatal(
+	Diagnostics(std::ostream& errIn, std::ostream& outIn)
+	: errStream(&errIn), outStream(&outIn), source(nullptr),
+	  fatalCount(0){ }
+	explicit Diagnostics(const SourceManager * sourceIn)
+	: errStream(nullptr), outStream(nullptr), source(sourceIn),
+	  fatalCount(0){ }
+
+	std::ostream& err(){ return *errStream; }
+	std::ostream& out(){ return *outStream; }
+
+	//Positions given as source offsets are resolved here
+	void setSource(const SourceManager * sourceIn){ source = sourceIn; }
+	const SourceManager * sourceManager() const { return source; }
+
+	void fatal(
 		size_t l, 
 		size_t c, 
 		const char * msg
 	){
-		std::cerr << "FATAL [" << l << "," << c << "]: " 
+		fatalCount++;
+		record(Diagnostic::FATAL, l, c, msg);
+		if (errStream == nullptr){ return; }
+		err() << "FATAL [" << l << "," << c << "]: " 
 		<< msg  << std::endl;
 	}
 
-	static void fatal(
+	void fatal(
 		size_t l, 
 		size_t c, 
 		const std::string msg
@@ -45,22 +88,93 @@ public:
 		fatal(l,c,msg.c_str());
 	}
 
-	static void warn(
+	void fatal(
+		SrcOffset at,
+		const std::string msg
+	){
+		fatal(source->line(at), source->col(at), msg.c_str());
+	}
+
+	//The parser's report of the token it could not accept
+	void syntax(SrcOffset at, const std::string msg){
+		fatalCount++;
+		record(Diagnostic::SYNTAX, source->line(at), source->col(at),
+		  msg);
+		if (errStream == nullptr){ return; }
+		out() << msg << std::endl;
+		err() << "syntax error" << std::endl;
+	}
+
+	void warn(
 		size_t l,
 		size_t c,
 		const char * msg
 	){
-		std::cerr << "*WARNING* [" << l << "," << c << "]: " 
+		record(Diagnostic::WARNING, l, c, msg);
+		if (errStream == nullptr){ return; }
+		err() << "*WARNING* [" << l << "," << c << "]: " 
 		<< msg  << std::endl;
 	}
 
-	static void warn(
+	void warn(
 		size_t l,
 		size_t c,
 		const std::string msg
 	){
 		warn(l,c,msg.c_str());
 	}
+
+	//An internal error that stopped the compilation. Only
+	// recorded; whoever caught it decides what to print
+	void internal(const std::string msg){
+		fatalCount++;
+		record(Diagnostic::INTERNAL, 0, 0, msg);
+	}
+
+	//Report a problem another sink recorded
+	void report(const Diagnostic& diag){
+		switch (diag.severity){
+		case Diagnostic::FATAL:
+			fatal(diag.line, diag.col, diag.message);
+			break;
+		case Diagnostic::SYNTAX:
+			fatalCount++;
+			record(diag.severity, diag.line, diag.col, diag.message);
+			if (errStream == nullptr){ break; }
+			out() << diag.message << std::endl;
+			err() << "syntax error" << std::endl;
+			break;
+		case Diagnostic::WARNING:
+			warn(diag.line, diag.col, diag.message);
+			break;
+		case Diagnostic::INTERNAL:
+			internal(diag.message);
+			break;
+		}
+	}
+
+	//Report everything other recorded, in the order it did
+	void replay(const Diagnostics& other){
+		for (const Diagnostic& diag : other.all()){
+			report(diag);
+		}
+	}
+
+	size_t fatals() const { return fatalCount; }
+	//Everything reported so far, in the order it was reported
+	const std::vector<Diagnostic>& all() const { return records; }
+private:
+	Diagnostics(const Diagnostics&) = delete;
+	Diagnostics& operator=(const Diagnostics&) = delete;
+	void record(Diagnostic::Severity severity, size_t l, size_t c,
+	  const std::string& msg){
+		records.push_back(Diagnostic{severity, l, c, msg});
+	}
+	std::ostream * errStream;
+	std::ostream * outStream;
+	const SourceManager * source;
+	size_t fatalCount;
+	std::vector<Diagnostic> records;
 };
 
 }
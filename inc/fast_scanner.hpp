@@ -0,0 +1,50 @@
+#ifndef HOLEYC_FAST_SCANNER_HPP
+#define HOLEYC_FAST_SCANNER_HPP
+
+#include "grammar.hh"
+#include "lexer.hpp"
+
+namespace holeyc{
+
+//A hand-written scanner for the language holeyc.l describes.
+// It matches exactly what the flex Scanner matches (longest
+// match, earlier rule on a tie) and reports the same errors at
+// the same offsets, but works on the input buffer in place: runs
+// of blanks, comments, identifiers and string bodies are skipped
+// a vector register at a time where the target has SSE2 or AVX2,
+// and integer literals are converted in the same pass that finds
+// their end.
+class FastScanner : public Lexer{
+public:
+	FastScanner(CompilationContext * ctxIn, Arena * tokenArenaIn)
+	: Lexer(ctxIn, tokenArenaIn){ }
+	//Scan only the input from begin up to end, interning into
+	// and reporting to the given interner and diagnostics rather
+	// than the context's. The piece of input should start at the
+	// start of a line and end at the end of one.
+	FastScanner(StringInterner * namesIn, Diagnostics * diagsIn,
+	  const SourceManager * srcIn, Arena * tokenArenaIn,
+	  SrcOffset begin, SrcOffset end)
+	: Lexer(namesIn, diagsIn, srcIn, tokenArenaIn){
+		tokenStart = nextOffset = begin;
+		inputEnd = end;
+	}
+
+	virtual int yylex(holeyc::Parser::semantic_type * const lval) override;
+private:
+	static const int NO_TOKEN = -1;
+
+	//Each of these matches at tokenStart, moves nextOffset past
+	// the match and returns the token kind, or NO_TOKEN if the
+	// match was an error and made no token
+	int makeBareToken(holeyc::Parser::semantic_type * lval, int kind,
+	  size_t len);
+	int lexWord(holeyc::Parser::semantic_type * lval);
+	int lexInt(holeyc::Parser::semantic_type * lval);
+	int lexString(holeyc::Parser::semantic_type * lval);
+	int lexCharLit(holeyc::Parser::semantic_type * lval);
+};
+
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef HOLEYC_HPP
+#define HOLEYC_HPP
+
+#include <sstream>
+#include <string>
+#include <vector>
+#include "session.hpp"
+
+//The embedding API of libholeyc. Link against libholeyc.a or
+// libholeyc.so and include this header to compile inputs held
+// in memory without going through holeycc or the filesystem.
+
+namespace holeyc{
+
+//One compilation of one input, run as far as the results asked
+// for need it to go. Nothing it reports is printed: diagnostics
+// are collected, both structured and as the text holeycc would
+// have printed, and internal errors are caught and reported
+// the same way rather than thrown at the caller. Compilations
+// share nothing, so separate ones may be used from separate
+// threads.
+class Compilation{
+public:
+	//The text is copied, so it need not outlive the call
+	static Compilation * fromString(const std::string& text,
+	  const char * name = "<input>");
+	//The bytes are compiled in place and must outlive the
+	// Compilation
+	static Compilation * fromBuffer(const char * data, size_t size,
+	  const char * name = "<input>");
+	static Compilation * fromFile(const char * path);
+	~Compilation();
+
+	//False if the input could not be loaded
+	bool good() const { return mySession.good(); }
+
+	//Each of these returns nullptr if the compilation failed
+	// before producing it
+	ProgramNode * ast();
+	NameAnalysis * nameAnalysis();
+	TypeAnalysis * typeAnalysis();
+	IRProgram * ir();
+	//The 3AC program, rendered as holeycc -a would write it
+	// (without the final newline). Returns false, leaving out
+	// untouched, if the program could not be generated
+	bool threeAC(std::string& out);
+
+	//Everything reported so far, in the order it was reported
+	const std::vector<Diagnostic>& diagnostics() const {
+		return mySession.context()->diags.all();
+	}
+	//The same diagnostics as holeycc would have printed them
+	std::string diagnosticText() const { return myText.str(); }
+
+	//The session underneath, for anything not covered here
+	CompilationSession * session(){ return &mySession; }
+private:
+	Compilation(SourceBuffer * source, const char * name);
+	Compilation(const Compilation&) = delete;
+	Compilation& operator=(const Compilation&) = delete;
+	template <typename Result, typename Phase>
+	Result * guard(Phase phase);
+
+	std::ostringstream myText;
+	CompilationSession mySession;
+	//Set once an internal error has stopped the compilation
+	bool crashed = false;
+};
+
+}
+
+#endif
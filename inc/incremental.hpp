@@ -0,0 +1,54 @@
+#ifndef HOLEYC_INCREMENTAL_HPP
+#define HOLEYC_INCREMENTAL_HPP
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ast.hpp"
+#include "types.hpp"
+#include "source.hpp"
+#include "cache.hpp"
+#include "3ac.hpp"
+
+namespace holeyc{
+
+//Which functions of a program can skip name analysis, type
+// analysis and lowering because an earlier compilation already
+// did them. Each global function gets a fingerprint covering
+// everything its 3AC could depend on: its own source text, and
+// the signature of each global its body names, as declared at
+// that point in the program. A function whose fingerprint is
+// in the cache has its procedure spliced in from there; the
+// rest are compiled as usual and, once the whole program has
+// compiled cleanly, stored under their fingerprints.
+class IncrementalPlan{
+public:
+	//ids are the ID nodes of ast in source order
+	IncrementalPlan(ProgramNode * ast, const std::vector<IDNode *>& ids,
+	  TypeContext * typesIn, const SourceManager * srcIn,
+	  const OutputCache * cache);
+
+	//The cached procedure for the given function declaration,
+	// or nullptr if it has to be compiled
+	const ProcTemplate * reused(NodeID fn) const;
+	//Store every procedure of prog that was compiled rather
+	// than spliced in
+	void storeFresh(IRProgram * prog, const OutputCache * cache) const;
+private:
+	std::string typeCode(TypeNode * typeNode) const;
+	std::string signature(DeclNode * decl) const;
+	//Takes the function's names from ids, starting at next and
+	// leaving next past the last one before spanEnd
+	std::string fingerprint(FnDeclNode * fn, size_t spanEnd,
+	  const std::vector<IDNode *>& ids, size_t& next,
+	  const std::unordered_map<NameID, std::string>& sigs) const;
+
+	TypeContext * types;
+	const SourceManager * src;
+	std::unordered_map<NodeID, std::string> fingerprints;
+	std::unordered_map<NodeID, ProcTemplate> hits;
+};
+
+}
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef HOLEYC_INTERNER_HPP
+#define HOLEYC_INTERNER_HPP
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace holeyc{
+
+//Dense index of an interned string. IDs are handed out in
+// order of first appearance, starting from 0, so they can
+// index directly into per-name tables.
+typedef uint32_t NameID;
+
+//An interned identifier. Two Idents from the same interner
+// are equal exactly when their text is equal, so comparing or
+// hashing one only ever looks at the ID. The text pointer is
+// carried along so that printing needs no interner lookup.
+class Ident{
+public:
+	Ident() : myID(0), myText(nullptr){ }
+	Ident(NameID idIn, const std::string * textIn)
+	: myID(idIn), myText(textIn){ }
+	NameID id() const { return myID; }
+	const std::string& text() const { return *myText; }
+	bool operator==(const Ident& other) const { 
+		return myID == other.myID; 
+	}
+	bool operator!=(const Ident& other) const { 
+		return myID != other.myID; 
+	}
+private:
+	NameID myID;
+	const std::string * myText;
+};
+
+//Owns one copy of every distinct identifier seen in a 
+// compilation. Lookups hash the raw characters straight out
+// of the scanner's buffer, so interning a name that has been
+// seen before allocates nothing.
+class StringInterner{
+public:
+	StringInterner();
+	Ident intern(const char * text, size_t len);
+	Ident intern(const std::string& text){
+		return intern(text.data(), text.size());
+	}
+	Ident get(NameID id) const { 
+		return Ident(id, &myStrings[id]); 
+	}
+	size_t size() const { return myStrings.size(); }
+private:
+	static uint32_t hash(const char * text, size_t len);
+	void grow();
+
+	//A deque never moves its elements, so the strings can be
+	// pointed at for as long as the interner lives
+	std::deque<std::string> myStrings;
+	std::vector<uint32_t> myHashes;
+	//Open-addressed table of (ID + 1), 0 marking an empty slot
+	std::vector<uint32_t> mySlots;
+};
+
+}
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef HOLEYC_LEXER_HPP
+#define HOLEYC_LEXER_HPP
+
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "arena.hpp"
+#include "context.hpp"
+#include "errors.hpp"
+#include "interner.hpp"
+#include "source.hpp"
+#include "token_stream.hpp"
+
+namespace holeyc{
+
+//What every scanner of the input has in common, whichever way
+// it matches: where it puts its tokens and names, where its
+// errors go, and the wording of those errors, so that the
+// scanners can be swapped for one another without the output
+// changing.
+class Lexer : public TokenSource{
+public:
+	//Make the scanner the context asks for (see LexerKind).
+	// Every token it makes is allocated in the given arena,
+	// identifiers are interned into the context's interner and
+	// errors are reported to its diagnostics
+	static Lexer * build(CompilationContext * ctx, Arena * tokenArena);
+	virtual ~Lexer(){ }
+
+	virtual SrcOffset lastOffset() const override{ return tokenStart; }
+
+	//The next token of the input; once the input runs out, an
+	// END token holding the EOF position
+	LexedToken next();
+	//Lex the whole input into the given list, holding the errors
+	// in errors instead of reporting them. The list always ends
+	// with an END token holding the EOF position
+	void lexAll(std::vector<LexedToken>& tokens, LexErrors& errors);
+
+	//Whether every character of the input has been matched
+	bool finished() const { return nextOffset >= inputEnd; }
+
+	//Allocate the tokens made from here on in a different arena
+	void setTokenArena(Arena * tokenArenaIn){ tokenArena = tokenArenaIn; }
+	//Report the errors found from here on to a different sink
+	void setDiagnostics(Diagnostics * diagsIn){ diags = diagsIn; }
+
+protected:
+	Lexer(CompilationContext * ctxIn, Arena * tokenArenaIn)
+	: Lexer(&ctxIn->names, &ctxIn->diags, ctxIn->source(), tokenArenaIn){ }
+	Lexer(StringInterner * namesIn, Diagnostics * diagsIn,
+	  const SourceManager * srcIn, Arena * tokenArenaIn)
+	: tokenArena(tokenArenaIn), names(namesIn), diags(diagsIn),
+	  src(srcIn), inputEnd(static_cast<SrcOffset>(srcIn->size())){ }
+
+	void errIllegal(std::string match){
+		fatal("Illegal character " + match);
+	}
+	void errChrEscEmpty(){
+		fatal("Empty escape sequence in character literal");
+	}
+	void errChrEmpty(){
+		fatal("Empty character literal");
+	}
+	void errChrEsc(){
+		fatal("Bad escape sequence in char literal");
+	}
+	void errStrEsc(){
+		fatal("String literal with bad escape sequence ignored");
+	}
+	void errStrUnterm(){
+		fatal("Unterminated string literal ignored");
+	}
+	void errStrEscAndUnterm(){
+		fatal("Unterminated string literal"
+		  "  with bad escape sequence ignored");
+	}
+	void errIntOverflow(){
+		fatal("Integer literal too large;  using max value");
+	}
+
+	//The value of the integer literal of len digits, worked out
+	// in one pass. Anything over INT_MAX, and anything over 10
+	// digits long whatever its value, is too large: that is
+	// reported, and INT_MAX used instead
+	int intValue(const char * digits, size_t len){
+		if (len > 10){
+			errIntOverflow();
+			return INT_MAX;
+		}
+		uint64_t val = 0;
+		for (size_t i = 0; i < len; i++){
+			val = val * 10 + static_cast<uint64_t>(digits[i] - '0');
+		}
+		if (val > INT_MAX){
+			errIntOverflow();
+			return INT_MAX;
+		}
+		return static_cast<int>(val);
+	}
+
+	Arena * tokenArena;
+	StringInterner * names;
+	Diagnostics * diags;
+	const SourceManager * src;
+	//Offsets of the current match and of the one after it
+	SrcOffset tokenStart = 0;
+	SrcOffset nextOffset = 0;
+	//Where the input to be matched ends
+	SrcOffset inputEnd;
+private:
+	Lexer(const Lexer&) = delete;
+	Lexer& operator=(const Lexer&) = delete;
+
+	//Report an error at the start of the current match
+	void fatal(const std::string msg){
+		diags->fatal(tokenStart, msg);
+	}
+};
+
+}
+
+#endif
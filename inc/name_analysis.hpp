@@ -3,26 +3,122 @@
 
 #include "ast.hpp"
 #include "symbol_table.hpp"
+#include "context.hpp"
+#include "arena.hpp"
 
 namespace holeyc{
 
+class IncrementalPlan;
+class GlobalIndex;
+
+//The result of name analysis: the symbol each identifier use
+// refers to, kept in a side table indexed by node ID so that
+// later phases can look it up from either form of the AST.
+// The analysis itself is done by the nodes, through a
+// NameWalker. Given a plan, the
+// bodies of the functions it reuses are not analyzed (their
+// identifiers are left unbound), though the functions
+// themselves are still declared.
+//With more than one thread, the globals are declared first,
+// in order, and then the function bodies are analyzed side by
+// side, each seeing the globals declared up to and including
+// its own function. Their diagnostics are reported in source
+// order once all are done, so the output is the same as with
+// one thread.
 class NameAnalysis{
 public:
-	static NameAnalysis * build(ProgramNode * astIn){
-		NameAnalysis * nameAnalysis = new NameAnalysis;
-		SymbolTable * symTab = new SymbolTable();
-		bool res = astIn->nameAnalysis(symTab);
-		delete symTab;
-		if (!res){ return nullptr; }
-
-		nameAnalysis->ast = astIn;
-		return nameAnalysis;
-	}
+	static NameAnalysis * build(ProgramNode * astIn,
+	  CompilationContext * ctx,
+	  const IncrementalPlan * planIn = nullptr, size_t threads = 1);
 	ProgramNode * ast;
+	CompilationContext * context;
+	const IncrementalPlan * plan;
+	NodeTable<SemSymbol *> symbols;
 
 private:
-	NameAnalysis(){
+	friend class GlobalNameScope;
+	NameAnalysis(size_t nodeCount) : symbols(nodeCount, nullptr){
+	}
+	bool analyzeParallel(ProgramNode * astIn, CompilationContext * ctx,
+	  const IncrementalPlan * planIn, size_t threads);
+};
+
+//What name analysis carries down the AST: the symbol table,
+// where to report problems and record the symbols found, and
+// the plan, if any. Each node's nameAnalysis() does the work
+// for that node, through the helpers here.
+class NameWalker{
+public:
+	NameWalker(Diagnostics * diagsIn, SymbolTable * symTabIn,
+	  NodeTable<SemSymbol *> * symbolsIn, const IncrementalPlan * planIn,
+	  Arena * localSymbolsIn = nullptr)
+	: diags(diagsIn), symTab(symTabIn), symbols(symbolsIn),
+	  plan(planIn), localSymbols(localSymbolsIn){ }
+	//Analyze every node of the list, in a scope of their own
+	template <typename T>
+	bool scope(NodeList<T> * list){
+		symTab->enterScope();
+		bool result = all(list);
+		symTab->leaveScope();
+		return result;
+	}
+	//Analyze every node of the list, in the current scope
+	template <typename T>
+	bool all(NodeList<T> * list){
+		bool result = true;
+		for (auto node : *list){
+			result = node->nameAnalysis(this) && result;
+		}
+		return result;
 	}
+	bool id(IDNode * node);
+	bool varDecl(VarDeclNode * decl);
+	bool fnDecl(FnDeclNode * fn);
+	//Declare a function, without looking at its formals or body
+	bool fnHeader(FnDeclNode * fn);
+	//Analyze a function's formals and body in a scope of their own
+	bool fnBody(FnDeclNode * fn);
+	//Look names the symbol table doesn't have up in globalsIn, as
+	// seen from the declaration at index declIn
+	void setGlobals(const GlobalIndex * globalsIn, size_t declIn){
+		globals = globalsIn;
+		globalsDecl = declIn;
+	}
+private:
+	SemSymbol * lookup(Ident name) const;
+
+	Diagnostics * diags;
+	SymbolTable * symTab;
+	NodeTable<SemSymbol *> * symbols;
+	const IncrementalPlan * plan;
+	//If set, where symbols below the global scope are made
+	Arena * localSymbols;
+	const GlobalIndex * globals = nullptr;
+	size_t globalsDecl = 0;
+};
+
+//Name analysis for a program that arrives one top-level
+// declaration at a time. Only the global scope is kept from
+// one declaration to the next: the symbols a declaration binds
+// inside itself are released by releaseLocals(). Problems are
+// reported to diagsIn rather than to the context.
+class GlobalNameScope{
+public:
+	GlobalNameScope(CompilationContext * ctxIn, Diagnostics * diagsIn);
+	~GlobalNameScope();
+	//Analyze the declaration decl, whose nodes are numbered
+	// from 0 up to nodeCount, in the global scope built up so
+	// far. Returns nullptr if it failed. The result has no
+	// ProgramNode.
+	NameAnalysis * analyze(DeclNode * decl, size_t nodeCount);
+	//Free the symbols bound inside the declarations analyzed
+	// so far. Nothing can refer to them afterwards.
+	void releaseLocals(){ localSymbols.reset(); }
+private:
+	CompilationContext * ctx;
+	Diagnostics * diags;
+	SymbolTable * symTab;
+	Arena localSymbols;
 };
 
 }
@@ -0,0 +1,60 @@
+#ifndef HOLEYC_PARALLEL_HPP
+#define HOLEYC_PARALLEL_HPP
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace holeyc{
+
+//The number of threads to split count tasks over when asked
+// for threads of them, 0 meaning one per hardware thread
+inline size_t workerCount(size_t threads, size_t count){
+	if (threads == 0){ threads = std::thread::hardware_concurrency(); }
+	if (threads == 0){ threads = 1; }
+	if (threads > count){ threads = count; }
+	return threads;
+}
+
+//Run task(i) for each i below count, on up to threads threads
+// (the calling one included). Each thread takes the next
+// unclaimed task until none are left, so a slow task doesn't
+// hold up the others. If tasks throw, the exception of the
+// first of them (by i) is rethrown once all are done, as a
+// loop over them would have thrown it.
+template <typename Task>
+void parallelFor(size_t count, size_t threads, Task task){
+	threads = workerCount(threads, count);
+	std::atomic<size_t> next(0);
+	std::exception_ptr thrown;
+	std::mutex thrownLock;
+	size_t firstThrown = count;
+	auto worker = [&](){
+		while (true){
+			size_t i = next.fetch_add(1);
+			if (i >= count){ return; }
+			try {
+				task(i);
+			} catch (...){
+				std::lock_guard<std::mutex> guard(thrownLock);
+				if (i < firstThrown){
+					firstThrown = i;
+					thrown = std::current_exception();
+				}
+			}
+		}
+	};
+	std::vector<std::thread> pool;
+	for (size_t t = 1; t < threads; t++){
+		pool.emplace_back(worker);
+	}
+	worker();
+	for (std::thread& thread : pool){ thread.join(); }
+	if (thrown){ std::rethrow_exception(thrown); }
+}
+
+}
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef HOLEYC_PIPELINED_LEXER_HPP
+#define HOLEYC_PIPELINED_LEXER_HPP
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "arena.hpp"
+#include "context.hpp"
+#include "errors.hpp"
+#include "lexer.hpp"
+#include "token_ring.hpp"
+#include "token_stream.hpp"
+
+namespace holeyc{
+
+//Lexes on a thread of its own while the parser pulls tokens
+// from the other end of an SpscRing, so that lexing overlaps
+// parsing and building the AST. The scanner can only get the
+// ring's capacity ahead of the parser.
+//The scanner's errors go through the ring along with the token
+// it was lexing when it found them, and are only reported once
+// the parser takes that token. So they come out in the same
+// order, among the syntax errors, as when the parser lexes as it
+// goes, and those the parser never gets as far as are not
+// reported at all.
+class PipelinedLexer : public TokenSource{
+public:
+	//Starts lexing at once, with the scanner the context asks
+	// for, making the tokens in tokenArena. Nothing else may
+	// use the context's interner or the arena until finish()
+	PipelinedLexer(CompilationContext * ctxIn, Arena * tokenArena);
+	//Stops the scanner if finish() wasn't called
+	~PipelinedLexer();
+
+	//Rethrows whatever the scanner threw, once the parser gets
+	// to where it threw
+	virtual int yylex(holeyc::Parser::semantic_type * const lval) override;
+	virtual SrcOffset lastOffset() const override{ return myLastOffset; }
+
+	//Stops the scanner, throwing away the tokens (and errors)
+	// the parser didn't take, and waits for it
+	void finish();
+private:
+	PipelinedLexer(const PipelinedLexer&) = delete;
+	PipelinedLexer& operator=(const PipelinedLexer&) = delete;
+
+	//A token and the errors lexing it reported, if there were any
+	struct Lexed{
+		LexedToken tok;
+		std::vector<Diagnostic> * errors;
+	};
+
+	//Lexed entries the scanner may get ahead by
+	static const size_t RING_TOKENS = 4096;
+
+	void produce();
+	std::vector<Diagnostic> * takeErrors();
+	void drain();
+
+	CompilationContext * ctx;
+	//Only the scanner's thread touches these two
+	Diagnostics lexDiags;
+	size_t errorsTaken = 0;
+	std::unique_ptr<Lexer> lexer;
+	SpscRing<Lexed> ring;
+	std::exception_ptr thrown;
+	std::atomic<bool> stopping{false};
+	std::thread thread;
+	bool sawEnd = false;
+	bool finished = false;
+	SrcOffset myLastOffset = 0;
+};
+
+}
+
+#endif
@@ -5,21 +5,34 @@
 #include <FlexLexer.h>
 #endif
 
+#include <cstring>
 #include "grammar.hh"
 #include "errors.hpp"
+#include "context.hpp"
+#include "lexer.hpp"
+#include "arena.hpp"
+#include "interner.hpp"
+#include "source.hpp"
 
 using TokenKind = holeyc::Parser::token;
 
 namespace holeyc{
 
-class Scanner : public yyFlexLexer{
+class Scanner : public yyFlexLexer, public Lexer{
 public:
    
-   Scanner(std::istream *in) : yyFlexLexer(in)
+   //Scan the in-memory input behind the given SourceManager
+   // (such as a mapped SourceBuffer) directly, without an
+   // istream in between. The input must outlive the scanner.
+   // Every token the scanner makes is allocated in the given
+   // arena, which is expected to outlive the scanner and to be
+   // released in bulk once the tokens have been consumed.
+   // Identifiers are interned into the context's interner and
+   // errors are reported to its diagnostics.
+   Scanner(CompilationContext * ctxIn, Arena * tokenArenaIn)
+   : yyFlexLexer(nullptr), Lexer(ctxIn, tokenArenaIn),
+     myInput(src->data()), myInputLen(src->size()), myInputPos(0)
    {
-	lineNum = 1;
-	colNum = 1;
-	hasError = false;
    };
    virtual ~Scanner() {
    };
@@ -28,101 +41,74 @@ public:
    using FlexLexer::yylex;
 
    // YY_DECL defined in the flex holeyc.l
-   virtual int yylex( holeyc::Parser::semantic_type * const lval);
+   virtual int yylex( holeyc::Parser::semantic_type * const lval) override;
 
-   int makeBareToken(int tagIn){
-        this->yylval->transToken = new Token(
-	  this->lineNum, this->colNum, tagIn);
-        colNum += static_cast<size_t>(yyleng);
-        return tagIn;
-   }
-
-   int makeCharLitToken(const std::string text){
-	char val;
-	if (text.length() == 2){
-		val = text.c_str()[1];
-	} else if (text == "'\\t"){
-		val = '\t';
-	} else if (text == "'\\n"){
-		val = '\n';
-	} else if (text == "'\\\\"){
-		val = '\\';
-	} else {
-		val = text.c_str()[1];
-	}
-	this->yylval->transToken = new CharLitToken(
-		this->lineNum, this->colNum, val);
-	colNum += static_cast<size_t>(yyleng);
-	return TokenKind::CHARLIT;
-   }
-
-   void errIllegal(size_t l, size_t c, std::string match){
-	Report::fatal(l, c, "Illegal character "
-		+ match);
-	hasError = true;
-   }
-
-   void errChrEscEmpty(size_t l, size_t c){
-	Report::fatal(l, c, "Empty escape sequence in"
-	" character literal");
-	hasError = true;
+   //Run before every action (as YY_USER_ACTION): the match
+   // in yytext starts where the previous one ended
+   void startMatch(){
+	tokenStart = nextOffset;
+	nextOffset += static_cast<SrcOffset>(yyleng);
    }
 
-   void errChrEmpty(size_t l, size_t c){
-	Report::fatal(l, c, "Empty character literal");
-	hasError = true;
-   }
-
-   void errChrEsc(size_t l, size_t c){
-	Report::fatal(l, c, "Bad escape sequence in"
-	" char literal");
-	hasError = true;
-   }
-
-   void errStrEsc(size_t l, size_t c){
-	Report::fatal(l, c, "String literal with bad"
-	" escape sequence ignored");
-	hasError = true;
+   int makeBareToken(int tagIn){
+        this->yylval->transToken = tokenArena->make<Token>(
+	  tokenStart, tagIn);
+        return tagIn;
    }
 
-   void errStrUnterm(size_t l, size_t c){
-	Report::fatal(l, c, "Unterminated string"
-	" literal ignored");
-	hasError = true;
-	
+   //The character a t, n or backslash stands for after a
+   // backslash in a character literal
+   static char escaped(char c){
+	if (c == 't'){ return '\t'; }
+	if (c == 'n'){ return '\n'; }
+	return c;
    }
 
-   void errStrEscAndUnterm(size_t l, size_t c){
-	Report::fatal(l, c, "Unterminated string literal"
-	"  with bad escape sequence ignored");
-	hasError = true;
+   int makeCharLitToken(char val){
+	this->yylval->transToken = tokenArena->make<CharLitToken>(
+		tokenStart, val);
+	return TokenKind::CHARLIT;
    }
 
-   void errIntOverflow(size_t l, size_t c){
-	Report::fatal(l, c, "Integer literal too large;"
-	"  using max value");
-	hasError = true;
+   //The text is seen in the input rather than in yytext, which
+   // flex overwrites as it goes. Like yytext as a C string, it
+   // stops at a NUL byte
+   int makeStrToken(){
+	const char * text = src->data() + tokenStart;
+	size_t len = static_cast<size_t>(yyleng);
+	const void * nul = memchr(text, '\0', len);
+	if (nul != nullptr){
+		len = static_cast<size_t>(static_cast<const char *>(nul) - text);
+	}
+	this->yylval->transToken = tokenArena->make<StrToken>(
+		tokenStart, TextView(text, len));
+	return TokenKind::STRLITERAL;
    }
 
    void warn(int lineNumIn, int colNumIn, std::string msg){
-	std::cerr << lineNumIn << ":" << colNumIn 
-		<< " ***WARNING*** " << msg << std::endl;
+	diags->warn(static_cast<size_t>(lineNumIn),
+		static_cast<size_t>(colNumIn), msg);
    }
 
    void error(int lineNumIn, int colNumIn, std::string msg){
-	std::cerr << lineNumIn << ":" << colNumIn 
-		<< " ***ERROR*** " << msg << std::endl;
+	diags->fatal(static_cast<size_t>(lineNumIn),
+		static_cast<size_t>(colNumIn), msg);
    }
 
    static std::string tokenKindString(int tokenKind);
 
-   void outputTokens(std::ostream& outstream);
+   static void outputTokens(const std::vector<LexedToken>& tokens,
+     const SourceManager& src, std::ostream& outstream);
+
+protected:
+   //Flex pulls its input through here a buffer at a time
+   virtual int LexerInput(char * buf, int maxSize) override;
 
 private:
    holeyc::Parser::semantic_type *yylval = nullptr;
-   size_t lineNum;
-   size_t colNum;
-   bool hasError;
+   const char * myInput = nullptr;
+   size_t myInputLen = 0;
+   size_t myInputPos = 0;
 };
 
 } /* end namespace */
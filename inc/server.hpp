@@ -0,0 +1,47 @@
+#ifndef HOLEYC_SERVER_HPP
+#define HOLEYC_SERVER_HPP
+
+#include <string>
+#include "driver.hpp"
+
+namespace holeyc{
+
+//holeycc --serve keeps a compiler resident behind a Unix domain
+// socket, and holeycc --client hands it one input at a time.
+// The client reads the input itself and the server never
+// touches the client's files: it sends back each output along
+// with everything that would have gone to stdout and stderr,
+// and the client writes them out. To the caller, a client run
+// looks just like running holeycc on the input directly.
+//
+//Each connection carries a single request and its response,
+// each a sequence of strings, each string a 32-bit length (in
+// host order, as both ends are on the same machine) followed
+// by its bytes:
+// request:  version, input name, input text, then the tokens,
+//           unparse, names and 3AC output paths (empty if not
+//           requested), then the flags: any of "p" (-p), "c"
+//           (-c), "s" (--stream) and "j" (--parallel), and
+//           "f" or "h" for the scanner --lexer picked
+// response: version, exit status, stdout text, stderr text,
+//           the number of output files, then a path and its
+//           contents for each of them
+//A request that is cut short or of another version gets a
+// response with exit status 1, the reason as its stderr text
+// and no output files.
+
+//Serve requests on the socket at socketPath until killed, using
+// the given number of worker threads (0 picks one per hardware
+// thread). Each worker keeps its own ResidentState, so workers
+// share nothing. Returns only if the socket can't be set up.
+int runServer(const char * socketPath, size_t threads);
+
+//Have the server at socketPath compile the input at inPath,
+// and write out what it sends back. Returns the exit status
+// holeycc would have had.
+int runClient(const char * socketPath, const char * inPath,
+  const DriverOptions& opts);
+
+}
+
+#endif
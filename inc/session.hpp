@@ -0,0 +1,135 @@
+#ifndef HOLEYC_SESSION_HPP
+#define HOLEYC_SESSION_HPP
+
+#include <string>
+#include <vector>
+#include "token_stream.hpp"
+#include "source.hpp"
+#include "arena.hpp"
+#include "interner.hpp"
+#include "context.hpp"
+#include "ast.hpp"
+#include "ast_builder.hpp"
+#include "name_analysis.hpp"
+#include "type_analysis.hpp"
+#include "3ac.hpp"
+#include "cache.hpp"
+#include "incremental.hpp"
+#include "chunked_lexer.hpp"
+#include "token_file.hpp"
+
+namespace holeyc{
+
+//A single compilation of a single input file. Each phase
+// (lexing, parsing, name analysis, type analysis and 3AC
+// generation) is run at most once, on demand, and its result
+// is kept so that every requested output is served from the
+// same front-end pass. A phase that failed stays failed:
+// asking for it again returns nullptr without re-running it
+// (and without re-reporting its errors). The one exception is
+// the token list: tokens live in an arena that is released as
+// soon as the parser is done with them, so they have to be
+// asked for before the AST is. Everything else the session
+// produced, the AST included, lives as long as the session
+// does.
+class CompilationSession{
+public:
+	//Diagnostics go to diagOut and the parser's detailed syntax
+	// error messages to msgOut
+	CompilationSession(const char * inPathIn,
+	  std::ostream& diagOut = std::cerr, std::ostream& msgOut = std::cout);
+	//Compile an input that is already in memory. The session
+	// takes ownership of the buffer, which may be null (if
+	// the input could not be loaded) to make a session that is
+	// not good(). The name is only used to identify the input.
+	//If a ResidentState is given, the session takes its names,
+	// types and arenas from there, and releases what it put in
+	// the arenas when it is destroyed.
+	CompilationSession(SourceBuffer * sourceIn, const char * nameIn,
+	  std::ostream& diagOut = std::cerr, std::ostream& msgOut = std::cout,
+	  ResidentState * resident = nullptr);
+	~CompilationSession();
+	//False if the input file could not be read
+	bool good() const { return source != nullptr; }
+	//Maps the offsets in tokens and nodes back to lines and
+	// columns. Only valid if the session is good()
+	const SourceManager * sourceManager() const { return srcMgr; }
+	//The names, types and diagnostics of this compilation
+	CompilationContext * context(){ return &ctx; }
+	const CompilationContext * context() const { return &ctx; }
+
+	//Reuse the procedures of unchanged functions from the given
+	// cache, which has to outlive the session's analyses. Only
+	// takes effect if set before name analysis runs.
+	void setFunctionCache(const OutputCache * cacheIn){ fnCache = cacheIn; }
+	//The functions name analysis was told to skip, or nullptr
+	// if there is no function cache
+	const IncrementalPlan * incrementalPlan() const { return myPlan; }
+	//Run lexing, name analysis, type analysis and lowering on
+	// this many threads (0 for one per hardware thread) instead
+	// of one. A large input lexed by the hand-written scanner is
+	// split up by lines (see ChunkedLexer); otherwise the lexer
+	// runs alongside the parser (see PipelinedLexer). The rest
+	// is split up by function. Only takes effect if set before
+	// they run.
+	void setThreads(size_t threadsIn){ threads = threadsIn; }
+	//Take the tokens from this file, which the session takes
+	// ownership of, rather than lexing the input. The file
+	// should have been written for this input. Only takes
+	// effect if set before lexing runs.
+	void setTokenFile(TokenFile * fileIn);
+
+	//Throws an InternalError once the tokens have been released
+	const std::vector<LexedToken> * tokens();
+	//The errors lexing tokens() (or loading them) reported, or
+	// nullptr once the tokens have been released
+	const LexErrors * lexErrors() const { return myLexErrors; }
+	ProgramNode * ast();
+	NameAnalysis * nameAnalysis();
+	TypeAnalysis * typeAnalysis();
+	IRProgram * ir();
+private:
+	enum PhaseState { NOT_RUN, DONE, FAILED, RELEASED };
+
+	std::string inPath;
+	SourceBuffer * source;
+	SourceManager * srcMgr = nullptr;
+	CompilationContext ctx;
+
+	//Lex the whole input into myTokens, holding the errors
+	void lexAll(LexErrors& errors);
+	void releaseTokens();
+	//Parse with the input lexed on a thread of its own
+	int parsePipelined();
+
+	//The arenas below unless the session has a ResidentState
+	Arena ownTokenArena;
+	Arena ownASTArena;
+
+	PhaseState lexState = NOT_RUN;
+	Arena * tokenArena;
+	//Holds the tokens if they were lexed on several threads
+	ChunkedLexer * chunkedLexer = nullptr;
+	TokenFile * tokenFile = nullptr;
+	std::vector<LexedToken> myTokens;
+	LexErrors * myLexErrors = nullptr;
+	PhaseState parseState = NOT_RUN;
+	//Holds every AST node and child list; the tree is freed
+	// in one go along with the session
+	Arena * astArena;
+	ASTBuilder astBuilder;
+	ProgramNode * myAST = nullptr;
+	const OutputCache * fnCache = nullptr;
+	IncrementalPlan * myPlan = nullptr;
+	size_t threads = 1;
+	PhaseState nameState = NOT_RUN;
+	NameAnalysis * myNameAnalysis = nullptr;
+	PhaseState typeState = NOT_RUN;
+	TypeAnalysis * myTypeAnalysis = nullptr;
+	PhaseState irState = NOT_RUN;
+	IRProgram * myIR = nullptr;
+};
+
+}
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef HOLEYC_SOURCE_HPP
+#define HOLEYC_SOURCE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace holeyc{
+
+//A position in the input, as a byte offset from its start.
+// Tokens and AST nodes carry one of these instead of a line
+// and column; a SourceManager turns it back into those.
+typedef uint32_t SrcOffset;
+
+//Bytes that live somewhere else, such as in a SourceBuffer,
+// seen without copying them: the std::string_view of C++17,
+// for a C++14 tree. It is only good for as long as the bytes
+// it looks at are.
+class TextView{
+public:
+	TextView() : myData(nullptr), mySize(0){ }
+	TextView(const char * dataIn, size_t sizeIn)
+	: myData(dataIn), mySize(sizeIn){ }
+	const char * data() const { return myData; }
+	size_t size() const { return mySize; }
+	std::string str() const { return std::string(myData, mySize); }
+private:
+	const char * myData;
+	size_t mySize;
+};
+
+//The bytes of a single input. Regular files are mapped
+// straight into memory with mmap, so the scanner can read
+// them without going through an istream. Anything that can't
+// be mapped (pipes, character devices, empty files) is read
+// into a buffer owned by this object instead. Inputs that are
+// already in memory are either copied into such a buffer or
+// borrowed in place. Either way the bytes stay put for the
+// lifetime of the SourceBuffer.
+class SourceBuffer{
+public:
+	//Returns nullptr if the file could not be opened or read,
+	// or is too large for its offsets to fit in a SrcOffset
+	static SourceBuffer * open(const char * path);
+	//Returns nullptr if the input is too large for a SrcOffset
+	static SourceBuffer * copy(const char * data, size_t size);
+	//As copy, but the bytes are used where they are and must
+	// outlive the SourceBuffer
+	static SourceBuffer * borrow(const char * data, size_t size);
+	~SourceBuffer();
+	const char * data() const { return myData; }
+	size_t size() const { return mySize; }
+	bool isMapped() const { return mapped; }
+private:
+	SourceBuffer() : myData(nullptr), mySize(0), mapped(false){ }
+	SourceBuffer(const SourceBuffer&) = delete;
+	SourceBuffer& operator=(const SourceBuffer&) = delete;
+	const char * myData;
+	size_t mySize;
+	bool mapped;
+	std::string owned;
+};
+
+//Recovers lines and columns from source offsets, using a
+// table of where each line starts. The table is built in one
+// pass up front; the line and column of an offset are only
+// worked out (by binary search) when a diagnostic or output
+// actually prints them. Lines and columns count from 1 and a
+// column counts bytes, so a tab is a single column.
+class SourceManager{
+public:
+	SourceManager(const char * dataIn, size_t sizeIn);
+	const char * data() const { return myData; }
+	size_t size() const { return mySize; }
+	size_t line(SrcOffset at) const;
+	size_t col(SrcOffset at) const;
+	//The position formatted as [line,col]
+	std::string pos(SrcOffset at) const;
+private:
+	size_t lineIndex(SrcOffset at) const;
+	const char * myData;
+	size_t mySize;
+	std::vector<SrcOffset> lineStarts;
+};
+
+}
+
+#endif
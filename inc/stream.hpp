@@ -0,0 +1,87 @@
+#ifndef HOLEYC_STREAM_HPP
+#define HOLEYC_STREAM_HPP
+
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include "arena.hpp"
+#include "ast_builder.hpp"
+#include "context.hpp"
+#include "name_analysis.hpp"
+#include "3ac.hpp"
+
+namespace holeyc{
+
+class Lexer;
+
+//Compiles a program one top-level declaration at a time.
+// HoleyC requires declaration before use, so as soon as the
+// parser finishes a declaration it can be name analyzed, type
+// checked and lowered against the globals declared before it,
+// after which its tokens, nodes, local symbols and quads are
+// all freed. What stays resident is the global scope, the
+// signatures in it, the globals and strings of the 3AC program
+// and the rendered procedures (which are spooled to a
+// temporary file), so peak memory follows the largest
+// declaration rather than the whole input.
+//Lexical and syntax errors are reported as the parser reaches
+// them. The errors of name and type analysis are held until
+// the end and then reported the way a whole-program
+// compilation would: the name errors only if the parse
+// succeeded, and the type errors only if every name resolved.
+// So the diagnostics are the same either way, as is the 3AC.
+class StreamCompiler : public DeclSink{
+public:
+	//Lowers to 3AC only if lower is set
+	StreamCompiler(CompilationContext * ctxIn, bool lower);
+	~StreamCompiler();
+
+	//Parse, analyze and (maybe) lower the whole input
+	void run();
+	bool parsed() const { return parseOK; }
+	//Whether every declaration passed name and type analysis
+	bool passed() const { return parseOK && namesOK && typesOK; }
+	//If lowering threw, what it threw, as the driver would
+	// report it; otherwise empty
+	const std::string& lowerError() const { return myLowerError; }
+	//After a run that passed and lowered without error, write
+	// the 3AC program as IRProgram::emit() would render it
+	void write3AC(std::ostream& out);
+
+	virtual void topLevel(DeclNode * decl, size_t nodeCount) override;
+private:
+	StreamCompiler(const StreamCompiler&) = delete;
+	StreamCompiler& operator=(const StreamCompiler&) = delete;
+
+	void lower(DeclNode * decl, TypeAnalysis * ta);
+	void spool(const std::string& text);
+
+	CompilationContext * ctx;
+	//Tokens are lexed into one arena while the other still
+	// holds those of the declaration before; see topLevel()
+	Arena tokenArenas[2];
+	size_t tokenSide = 0;
+	Lexer * scanner = nullptr;
+	Arena astArena;
+	ASTBuilder builder;
+	//Held until the whole input is parsed; see run()
+	Diagnostics nameDiags;
+	Diagnostics typeDiags;
+	GlobalNameScope names;
+	IRProgram * prog = nullptr;
+
+	bool parseOK = false;
+	bool namesOK = true;
+	bool typesOK = true;
+	std::string myLowerError;
+
+	//Where rendered procedures wait for the globals section,
+	// which can only be written once the whole input is seen.
+	// They are kept in memory if no temporary file could be made
+	FILE * spoolFile = nullptr;
+	std::string spoolText;
+};
+
+}
+
+#endif
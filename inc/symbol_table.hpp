@@ -1,9 +1,12 @@
 #ifndef HOLEYC_SYMBOL_TABLE_HPP
 #define HOLEYC_SYMBOL_TABLE_HPP
+#include <ostream>
 #include <string>
 #include <unordered_map>
 #include <list>
+#include <vector>
 #include "types.hpp"
+#include "interner.hpp"
 
 //Use an alias template so that we can use
 // "HashMap" and it means "std::unordered_map"
@@ -26,10 +29,11 @@ enum SymbolKind {
 // symbol table. 
 class SemSymbol {
 public:
-	SemSymbol(std::string nameIn, DataType * typeIn) 
+	SemSymbol(Ident nameIn, DataType * typeIn) 
 	: myName(nameIn), myType(typeIn){ }
 	virtual std::string toString();
-	std::string getName() const { return myName; }
+	const std::string& getName() const { return myName.text(); }
+	Ident getIdent() const { return myName; }
 	virtual SymbolKind getKind() const = 0;
 
 	virtual DataType * getDataType() const{
@@ -43,66 +47,72 @@ public:
 		return "UNKNOWN KIND";
 	} 
 private:
-	std::string myName;
+	Ident myName;
 	DataType * myType;
 };
 
 class VarSymbol : public SemSymbol {
 public:
-	VarSymbol(std::string name, DataType * type) 
+	VarSymbol(Ident name, DataType * type) 
 	: SemSymbol(name, type) { }
 	virtual SymbolKind getKind() const override { return VAR; } 
 };
 
 class FnSymbol : public SemSymbol{
 public:
-	FnSymbol(std::string name, FnType * fnType)
+	FnSymbol(Ident name, FnType * fnType)
 	: SemSymbol(name, fnType){ }
 	virtual SymbolKind getKind() const { return FN; }
 	SymbolKind getKind(){ return FN; } 
 };
 
-//A single scope. The symbol table is broken down into a 
-// chain of scope tables, and each scope table holds 
-// semantic symbols for a single scope. For example,
-// the globals scope will be represented by a ScopeTable,
-// and the contents of each function can be represented by
-// a ScopeTable.
-class ScopeTable {
+//The set of symbols visible at a point in the program.
+// Rather than a chain of per-scope maps, every name has its
+// own stack of bindings, innermost on top, so looking a name
+// up costs the same at any nesting depth. All bindings live
+// in a single vector in the order they were made, which
+// doubles as the undo log: leaving a scope pops the bindings
+// made since the matching enterScope and restores whatever
+// each one shadowed.
+class SymbolTable{
 	public:
-		ScopeTable();
-		SemSymbol * lookup(std::string name);
+		SymbolTable(TypeContext * typesIn);
+		//Where the types of declared names are built
+		TypeContext * types() const { return myTypes; }
+		void enterScope();
+		void leaveScope();
+		size_t depth() const { return scopeMarks.size(); }
 		bool insert(SemSymbol * symbol);
-		bool clash(std::string name);
-		std::string toString();
-		void addVar(std::string name, DataType * type){
+		SemSymbol * find(Ident varName) const;
+		//True if the name is already bound in the current scope
+		bool clash(Ident name) const;
+		void addVar(Ident name, DataType * type){
 			insert(new VarSymbol(name, type));
 		}
-		void addFn(std::string name, FnType * type){
+		void addFn(Ident name, FnType * type){
 			insert(new FnSymbol(name, type));
 		}
+		//List the bindings, innermost scope last, to out (such as
+		// the message stream of the compilation's Diagnostics)
+		void print(std::ostream& out) const;
 	private:
-		HashMap<std::string, SemSymbol *> * symbols;
-};
+		static const uint32_t NO_BINDING = UINT32_MAX;
+		struct Binding{
+			SemSymbol * symbol;
+			NameID name;
+			//Scope depth the binding was made at
+			uint32_t depth;
+			//The binding of the same name this one shadows
+			uint32_t shadowed;
+		};
+		uint32_t innermost(Ident name) const;
 
-class SymbolTable{
-	public:
-		SymbolTable();
-		ScopeTable * enterScope();
-		void leaveScope();
-		ScopeTable * getCurrentScope();
-		bool insert(SemSymbol * symbol);
-		SemSymbol * find(std::string varName);
-		bool clash(std::string name);
-		void addVar(std::string name, DataType * type){
-			getCurrentScope()->addVar(name, type);
-		}
-		void addFn(std::string name, FnType * type){
-			getCurrentScope()->addFn(name, type);
-		}
-		void print();
-	private:
-		std::list<ScopeTable *> * scopeTableChain;
+		TypeContext * myTypes;
+		std::vector<Binding> bindings;
+		//Innermost binding of each name, indexed by NameID
+		std::vector<uint32_t> heads;
+		//Size of bindings at each enterScope
+		std::vector<uint32_t> scopeMarks;
 };
 
 	
@@ -0,0 +1,90 @@
+#ifndef HOLEYC_TOKEN_FILE_HPP
+#define HOLEYC_TOKEN_FILE_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "arena.hpp"
+#include "context.hpp"
+#include "errors.hpp"
+#include "source.hpp"
+#include "token_stream.hpp"
+
+namespace holeyc{
+
+//The lexer's output for one input, stored so that it can be
+// parsed again without lexing. The file is a header, a record
+// of fixed size per token and per lexical error, and a table of
+// the strings they refer to:
+//  - a token is its kind, its offset and a payload: the value
+//    of an integer or character literal, or the index in the
+//    table of the text of a name or string literal
+//  - a lexical error is the index of the token it was found
+//    lexing, its severity, line, column and the index of its
+//    message
+//  - the table is the offset of each string in the bytes that
+//    follow it, plus one past the last, and then the bytes
+//Every text appears in the table once however often it is
+// used. Numbers are written in the byte order of the machine
+// that wrote them. The header holds the same key the
+// OutputCache would give the input, so a file is only read
+// back for the input, and by the compiler, that wrote it.
+class TokenFile{
+public:
+	//Write the tokens of the given input, ending with END, along
+	// with the errors that lexing them reported
+	static void write(const std::vector<LexedToken>& tokens,
+	  const LexErrors& lexErrors,
+	  const SourceManager& src, std::ostream& out);
+
+	//Returns nullptr if the file could not be read or is not
+	// a well-formed token file. Regular files are mapped rather
+	// than read
+	static TokenFile * open(const char * path);
+	~TokenFile();
+
+	//Whether this file was written for the given input
+	bool matches(const SourceManager& src) const;
+	//Add the stored tokens to the list, making them in
+	// tokenArena, and the stored errors to errors, as lexing
+	// them would. The names are interned in the order they come
+	// up, as the scanner would. String literals are seen in the
+	// file, which has to outlive their tokens
+	void load(CompilationContext * ctx, Arena * tokenArena,
+	  std::vector<LexedToken>& tokens, LexErrors& errors) const;
+private:
+	struct Header;
+	struct TokenRecord;
+	struct DiagRecord;
+
+	explicit TokenFile(SourceBuffer * bufIn) : buf(bufIn){ }
+	TokenFile(const TokenFile&) = delete;
+	TokenFile& operator=(const TokenFile&) = delete;
+
+	bool validate();
+	TokenRecord token(size_t index) const;
+	DiagRecord diag(size_t index) const;
+	uint32_t stringStart(size_t index) const;
+	const char * stringText(uint32_t index, size_t& len) const;
+
+	SourceBuffer * buf;
+	std::string key;
+	size_t sourceSize = 0;
+	size_t tokenCount = 0;
+	size_t diagCount = 0;
+	size_t stringCount = 0;
+	//Where each part starts in the buffer
+	size_t tokensAt = 0;
+	size_t diagsAt = 0;
+	size_t startsAt = 0;
+	size_t bytesAt = 0;
+};
+
+//Bump whenever the layout of a token file, or the meaning of
+// the token kinds stored in it, changes
+static const char * const TOKEN_FORMAT = "holeycc-tokens-2";
+
+}
+
+#endif
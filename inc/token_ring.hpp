@@ -0,0 +1,75 @@
+#ifndef HOLEYC_TOKEN_RING_HPP
+#define HOLEYC_TOKEN_RING_HPP
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace holeyc{
+
+//A bounded queue from exactly one producing thread to exactly
+// one consuming thread, without locks. Each side owns one index
+// and only reads the other's, so a push or pop is a load and a
+// store; each side also keeps the last value it saw of the
+// other's index, and only looks again when that one says the
+// ring is full (or empty). A push that finds the ring full
+// waits for the consumer, so the producer can never get more
+// than the capacity ahead.
+template <typename T>
+class SpscRing{
+public:
+	//The capacity is rounded up to a power of two
+	explicit SpscRing(size_t capacity){
+		size_t size = 1;
+		while (size < capacity){ size *= 2; }
+		slots.resize(size);
+		mask = size - 1;
+	}
+
+	//Producer only. Blocks while the ring is full
+	void push(const T& item){
+		size_t tail = myTail.load(std::memory_order_relaxed);
+		while (tail - headSeen > mask){
+			headSeen = myHead.load(std::memory_order_acquire);
+			if (tail - headSeen > mask){ std::this_thread::yield(); }
+		}
+		slots[tail & mask] = item;
+		myTail.store(tail + 1, std::memory_order_release);
+	}
+
+	//Consumer only. Blocks while the ring is empty
+	T pop(){
+		size_t head = myHead.load(std::memory_order_relaxed);
+		while (head == tailSeen){
+			tailSeen = myTail.load(std::memory_order_acquire);
+			if (head == tailSeen){ std::this_thread::yield(); }
+		}
+		T item = slots[head & mask];
+		myHead.store(head + 1, std::memory_order_release);
+		return item;
+	}
+private:
+	SpscRing(const SpscRing&) = delete;
+	SpscRing& operator=(const SpscRing&) = delete;
+
+	//The indices only ever grow; a slot is index & mask. Each
+	// side's fields are padded onto a cache line of their own,
+	// so that the two threads don't keep taking it from each
+	// other
+	static const size_t LINE = 64;
+	std::vector<T> slots;
+	size_t mask;
+	char padStart[LINE];
+	//Written by the consumer
+	std::atomic<size_t> myHead{0};
+	size_t tailSeen = 0;
+	char padHead[LINE - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+	//Written by the producer
+	std::atomic<size_t> myTail{0};
+	size_t headSeen = 0;
+	char padTail[LINE - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+};
+
+}
+
+#endif
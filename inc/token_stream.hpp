@@ -0,0 +1,99 @@
+#ifndef HOLEYC_TOKEN_STREAM_HPP
+#define HOLEYC_TOKEN_STREAM_HPP
+
+#include <vector>
+#include "errors.hpp"
+#include "grammar.hh"
+#include "tokens.hpp"
+
+namespace holeyc{
+
+//A single token as handed from the lexer to the parser:
+// the token kind and the token object carrying its value
+// and position.
+struct LexedToken{
+	int kind;
+	Token * token;
+};
+
+//Anything the parser can pull tokens from. The Scanner
+// is the obvious one, but tokens may also be replayed
+// out of a buffer that has already been lexed.
+class TokenSource{
+public:
+	virtual ~TokenSource(){ }
+	virtual int yylex(holeyc::Parser::semantic_type * const lval) = 0;
+	//Where the token most recently handed out starts
+	virtual SrcOffset lastOffset() const = 0;
+};
+
+//The errors found lexing a token list, each with the index in
+// the list of the token the scanner was lexing when it found it.
+// A parser that lexes as it goes gets each error reported just
+// before that token, which is when a TokenReplay given the
+// errors reports them too.
+class LexErrors{
+public:
+	explicit LexErrors(const SourceManager * src) : diags(src){ }
+	//Where a scanner lexing the list should report to
+	Diagnostics * sink(){ return &diags; }
+	//The errors reported to sink() since the last call were
+	// found lexing the token at index
+	void mark(size_t index){
+		while (indices.size() < diags.all().size()){
+			indices.push_back(index);
+		}
+	}
+	//An error found lexing the token at index
+	void add(size_t index, const Diagnostic& diag){
+		diags.report(diag);
+		indices.push_back(index);
+	}
+	size_t size() const { return indices.size(); }
+	const Diagnostic& at(size_t i) const { return diags.all()[i]; }
+	size_t tokenAt(size_t i) const { return indices[i]; }
+	//Report them all at once, as lexing up front does
+	void reportTo(Diagnostics& to) const { to.replay(diags); }
+private:
+	Diagnostics diags;
+	std::vector<size_t> indices;
+};
+
+//Replays a token list produced by an earlier lexing pass, so
+// that one lexing pass can serve both the token output and
+// the parser. The list is expected to end with the END token.
+//If given the errors found lexing the list, it reports each
+// one to diagsIn as it hands out the token it was found lexing.
+class TokenReplay : public TokenSource{
+public:
+	TokenReplay(const std::vector<LexedToken> * tokensIn,
+	  const LexErrors * errorsIn = nullptr, Diagnostics * diagsIn = nullptr)
+	: myTokens(tokensIn), myPos(0), myErrors(errorsIn), myDiags(diagsIn),
+	  myNextError(0){ }
+	virtual int yylex(holeyc::Parser::semantic_type * const lval) override{
+		if (myPos >= myTokens->size()){
+			return holeyc::Parser::token::END;
+		}
+		while (myErrors != nullptr && myNextError < myErrors->size()
+		  && myErrors->tokenAt(myNextError) <= myPos){
+			myDiags->report(myErrors->at(myNextError++));
+		}
+		const LexedToken& tok = (*myTokens)[myPos++];
+		lval->transToken = tok.token;
+		return tok.kind;
+	}
+	virtual SrcOffset lastOffset() const override{
+		if (myPos == 0){ return 0; }
+		return (*myTokens)[myPos - 1].token->offset();
+	}
+private:
+	const std::vector<LexedToken> * myTokens;
+	size_t myPos;
+	const LexErrors * myErrors;
+	Diagnostics * myDiags;
+	size_t myNextError;
+};
+
+}
+
+#endif
@@ -2,45 +2,48 @@
 #define HOLYC_TOKEN_H
 
 #include <string>
+#include "interner.hpp"
+#include "source.hpp"
 
 namespace holeyc{
 
 class Token{
 public:
-	Token(size_t lineIn, size_t columnIn, int kindIn);
-	virtual std::string toString();
-	size_t line() const;
-	size_t col() const;
+	Token(SrcOffset offsetIn, int kindIn);
+	virtual std::string toString(const SourceManager& src);
+	SrcOffset offset() const;
 	int kind() const;
 private:
-	const size_t myLine;
-	const size_t myCol;
+	const SrcOffset myOffset;
 	const int myKind;
 };
 
 class IDToken : public Token{
 public:
-	IDToken(size_t lIn, size_t cIn, std::string valIn);
-	const std::string value() const;
-	virtual std::string toString() override;
+	IDToken(SrcOffset offsetIn, Ident valIn);
+	Ident value() const;
+	virtual std::string toString(const SourceManager& src) override;
 private:
-	const std::string myValue;
-	
+	const Ident myValue;
+
 };
 
+//The text is not copied: it is seen where it lies in the
+// input (or wherever else the scanner found it), which has to
+// outlive the token
 class StrToken : public Token{
 public:
-	StrToken(size_t lIn, size_t cIn, std::string valIn);
-	virtual std::string toString() override;
-	const std::string str() const;
+	StrToken(SrcOffset offsetIn, TextView valIn);
+	virtual std::string toString(const SourceManager& src) override;
+	TextView str() const;
 private:
-	const std::string myStr;
+	const TextView myStr;
 };
 
 class CharLitToken : public Token{
 public:
-	CharLitToken(size_t lIn, size_t cIn, char valIn);
-	virtual std::string toString() override;
+	CharLitToken(SrcOffset offsetIn, char valIn);
+	virtual std::string toString(const SourceManager& src) override;
 	char val() const;
 private:
 	const char myVal;
@@ -48,8 +51,8 @@ private:
 
 class IntLitToken : public Token{
 public:
-	IntLitToken(size_t lIn, size_t cIn, int numIn);
-	virtual std::string toString() override;
+	IntLitToken(SrcOffset offsetIn, int numIn);
+	virtual std::string toString(const SourceManager& src) override;
 	int num() const;
 private:
 	const int myNum;
@@ -4,28 +4,56 @@
 #include "ast.hpp"
 #include "symbol_table.hpp"
 #include "types.hpp"
+#include "context.hpp"
 
 class NameAnalysis;
 
 namespace holeyc{
 
+class IncrementalPlan;
+struct ProcTemplate;
+
 // An instance of this class will be passed over the entire
 // AST. Rather than attaching types to each node, the 
-// TypeAnalysis class contains a map from each ASTNode to it's
-// DataType. Thus, instead of attaching a type field to most nodes,
-// one can instead map the node to it's type, or lookup the node
-// in the map.
+// TypeAnalysis class contains a side table from each ASTNode to
+// it's DataType. Thus, instead of attaching a type field to most 
+// nodes, one can instead map the node to it's type, or lookup the
+// node in the table.
 class TypeAnalysis {
 
 private:
 	//The private constructor here means that the type analysis
 	// can only be created via the static build function
-	TypeAnalysis(){
+	TypeAnalysis(CompilationContext * ctx,
+	  const NodeTable<SemSymbol *> * symbolsIn, size_t nodeCount,
+	  const IncrementalPlan * planIn)
+	: myTypes(&ctx->types), myDiags(&ctx->diags), mySymbols(symbolsIn),
+	  myPlan(planIn), ownNodeTypes(nodeCount, nullptr),
+	  nodeToType(&ownNodeTypes){
+		hasError = false;
+	}
+	//A worker checking some of parent's declarations. It fills
+	// in parent's table, but has its own errors
+	TypeAnalysis(const TypeAnalysis * parent, Diagnostics * diagsIn)
+	: myTypes(parent->myTypes), myDiags(diagsIn),
+	  mySymbols(parent->mySymbols), myPlan(parent->myPlan),
+	  ownNodeTypes(0, nullptr), nodeToType(parent->nodeToType),
+	  currentFnType(nullptr), ast(parent->ast){
 		hasError = false;
 	}
+	bool analyzeParallel(size_t threads);
 
 public:
-	static TypeAnalysis * build(NameAnalysis * astRoot);
+	//With more than one thread, the global declarations are
+	// checked side by side, and their errors reported in source
+	// order once all are done, as one thread would have
+	static TypeAnalysis * build(NameAnalysis * astRoot,
+	  size_t threads = 1);
+	//Check a single top-level declaration, analyzed by a
+	// GlobalNameScope, whose nodes are numbered below nodeCount.
+	// Errors are reported to diags
+	static TypeAnalysis * build(NameAnalysis * nameAnalysis,
+	  DeclNode * decl, size_t nodeCount, Diagnostics * diags);
 	//static TypeAnalysis * build();
 
 	//The type analysis has an instance variable to say whether
@@ -36,6 +64,19 @@ public:
 		return !hasError;
 	}
 
+	//The context every compound type in this analysis comes
+	// from, so that types can be compared by pointer
+	TypeContext * types() const { return myTypes; }
+
+	//The symbol name analysis bound to an identifier use
+	SemSymbol * symbolOf(const IDNode * id) const {
+		return (*mySymbols)[id];
+	}
+
+	//The cached procedure standing in for the given function,
+	// or nullptr if it is analyzed and lowered as usual
+	const ProcTemplate * reusedProc(const ASTNode * fn) const;
+
 	void setCurrentFnType(const FnType * type){
 		currentFnType = type;
 	}
@@ -47,163 +88,170 @@ public:
 	
 	//Set the type of a node. Note that the function name is 
 	// overloaded: this 2-argument nodeType puts a value into the
-	// map with a given type. 
+	// table with a given type. 
 	void nodeType(const ASTNode * node, const DataType * type){
-		nodeToType[node] = type;
+		(*nodeToType)[node] = type;
 	}
 
 	//Gets the type of a node already placed in the map. Note
 	// that this function name is overloaded: the 1-argument nodeType
-	// gets the type of the given node out of the map.
-	const DataType * nodeType(const ASTNode * node){
-		const DataType * res = nodeToType[node];
+	// gets the type of the given node out of the table.
+	const DataType * nodeType(const ASTNode * node) const {
+		const DataType * res = (*nodeToType)[node];
 		if (res == nullptr){
 			const char * msg = "No type for node ";
 			throw new InternalError(msg);
 		}
-		return nodeToType[node];
+		return res;
 	}
 
 	//The following functions all report and error and 
 	// tell the object that the analysis has failed. 
 
-	void badWriteFn(size_t line, size_t col){
+	void badWriteFn(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col,
+		myDiags->fatal(at,
 			"Attempt to output a function");
 	}
 
-	void badWriteVoid(size_t line, size_t col){
+	void badWriteVoid(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col, 
+		myDiags->fatal(at, 
 			"Attempt to write void");
 	}
 
-	void badReadFn(size_t line, size_t col){
+	void badReadFn(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col,
+		myDiags->fatal(at,
 			"Attempt to read a function");
 	}
 
-	void badCallee(size_t line, size_t col){
+	void badCallee(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col,
+		myDiags->fatal(at,
 			"Attempt to call a "
 			"non-function");
 	}
-	void badArgCount(size_t line, size_t col){
+	void badArgCount(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col,
+		myDiags->fatal(at,
 			"Function call with wrong"
 			" number of args");
 	}
-	void badArgMatch(size_t line, size_t col){
+	void badArgMatch(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col, 
+		myDiags->fatal(at, 
 			"Type of actual does not match"
 			" type of formal");
 	}
-	void badNoRet(size_t line, size_t col){
+	void badNoRet(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col, 
+		myDiags->fatal(at, 
 			"Missing return value");
 	}
-	void extraRetValue(size_t line, size_t col){
+	void extraRetValue(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col, 
+		myDiags->fatal(at, 
 			"Return with a value in void"
 			" function");
 	}
-	void badRetValue(size_t line, size_t col){
+	void badRetValue(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col, 
+		myDiags->fatal(at, 
 			"Bad return value");
 	}
-	void badMathOpd(size_t line, size_t col){
+	void badMathOpd(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col, 
+		myDiags->fatal(at, 
 			"Arithmetic operator applied"
 			" to invalid operand");
 	}
-	void badMathOpr(size_t line, size_t col){
+	void badMathOpr(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col, 
+		myDiags->fatal(at, 
 			"Arithmetic operator applied"
 			" to incompatible operands");
 	}
-	void badRelOpd(size_t line, size_t col){
+	void badRelOpd(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col,
+		myDiags->fatal(at,
 			"Relational operator applied to"
 			" non-numeric operand");
 	}
-	void badLogicOpd(size_t line, size_t col){
+	void badLogicOpd(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col,
+		myDiags->fatal(at,
 			"Logical operator applied to"
 			" non-bool operand");
 	}
-	void badIfCond(size_t line, size_t col){
+	void badIfCond(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col, 
+		myDiags->fatal(at, 
 			"Non-bool expression used as"
 			" an if condition");
 	}
-	void badWhileCond(size_t line, size_t col){
+	void badWhileCond(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col,
+		myDiags->fatal(at,
 			"Non-bool expression used as"
 			" a while condition");
 	}
-	void badEqOpd(size_t line, size_t col){
+	void badEqOpd(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col, 
+		myDiags->fatal(at, 
 			"Invalid equality operand");
 	}
-	void badEqOpr(size_t line, size_t col){
+	void badEqOpr(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col, 
+		myDiags->fatal(at, 
 			"Invalid equality operation");
 	}
-	void badAssignOpr(size_t line, size_t col){
+	void badAssignOpr(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col, 
+		myDiags->fatal(at, 
 			"Invalid assignment operation");
 	}
-	void badAssignOpd(size_t line, size_t col){
+	void badAssignOpd(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col, 
+		myDiags->fatal(at, 
 			"Invalid assignment operand");
 	}
 
-	void badWritePtr(size_t line, size_t col){
+	void badWritePtr(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col,
+		myDiags->fatal(at,
 			"Attempt to write a raw pointer");
 	}
 
 	
-	void fnDeref(size_t line, size_t col){
+	void fnDeref(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col,
+		myDiags->fatal(at,
 			"Attempt to dereference a function");
 	}
-	void badIndex(size_t line, size_t col){
+	void badIndex(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col, "Bad index type");
+		myDiags->fatal(at, "Bad index type");
 	}
-	void badPtrBase(size_t line, size_t col){
+	void badPtrBase(SrcOffset at){
 		hasError = true;
-		Report::fatal(line, col, "Attempt to index"
+		myDiags->fatal(at, "Attempt to index"
 		  "a non-pointer type"
 		);
 	}
-	void badRefOpd(size_t line, size_t col){
-		Report::fatal(line, col, "Invalid ref operand");
+	void badRefOpd(SrcOffset at){
+		myDiags->fatal(at, "Invalid ref operand");
 	}
 
 private:
-	HashMap<const ASTNode *, const DataType *> nodeToType;
+	TypeContext * myTypes;
+	Diagnostics * myDiags;
+	const NodeTable<SemSymbol *> * mySymbols;
+	const IncrementalPlan * myPlan;
+	NodeTable<const DataType *> ownNodeTypes;
+	//ownNodeTypes, or for a worker its parent's. Each node is
+	// only ever typed by one worker.
+	NodeTable<const DataType *> * nodeToType;
 	const FnType * currentFnType;
 	bool hasError;
 public:
@@ -1,8 +1,11 @@
 #ifndef XXLANG_DATA_TYPES
 #define XXLANG_DATA_TYPES
 
+#include <cstdint>
 #include <list>
+#include <mutex>
 #include <sstream>
+#include <vector>
 #include "err.hpp"
 #include "errors.hpp"
 
@@ -24,6 +27,7 @@ class BasicType;
 class FnType;
 class PtrType;
 class ErrorType;
+class TypeContext;
 
 enum BaseType{
 	INT, VOID, BOOL, CHAR
@@ -35,6 +39,7 @@ enum BaseType{
 // using the is<X> functions.
 class DataType{
 public:
+	virtual ~DataType(){ }
 	virtual std::string getString() const = 0;
 	virtual const BasicType * asBasic() const { return nullptr; }
 	virtual const PtrType * asPtr() const { return nullptr; }
@@ -50,19 +55,11 @@ public:
 protected:
 };
 
-//This DataType subclass is the superclass for all holeyc types. 
-// Note that there is exactly one instance of this 
+//This DataType subclass is the type of an erroneous expression.
+// Note that there is exactly one instance of this per TypeContext
+// (see TypeContext::error)
 class ErrorType : public DataType{
 public:
-	static ErrorType * produce(){
-		//Note: this static member will only ever be initialized 
-		// ONCE, no matter how many times the function is called.
-		// That means there will only ever be 1 instance of errorType
-		// in the entire codebase.
-		static ErrorType * error = new ErrorType();
-		
-		return error;
-	}
 	virtual const ErrorType * asError() const override { return this; }
 	virtual std::string getString() const override { 
 		return "ERROR";
@@ -70,59 +67,20 @@ public:
 	virtual bool validVarType() const override { return false; }
 	virtual size_t getSize() const override { return 0; }
 private:
+	friend class TypeContext;
 	ErrorType(){ 
 		/* private constructor, can only 
-		be called from produce */
+		be called from TypeContext */
 	}
 	size_t line;
 	size_t col;
 };
 
 //DataType subclass for all scalar types 
+// Each TypeContext holds exactly one instance of each scalar
+// type, so comparing two scalar types is a pointer compare.
 class BasicType : public DataType{
 public:
-	static BasicType * VOID(){
-		return produce(BaseType::VOID);
-	}
-	static BasicType * BOOL(){
-		return produce(BaseType::BOOL);
-	}
-	static BasicType * CHAR(){
-		return produce(BaseType::CHAR);
-	}
-	static BasicType * INT(){
-		return produce(BaseType::INT);
-	}
-
-	//Create a scalar type. If that type already exists,
-	// return the known instance of that type. Making sure
-	// there is only 1 instance of a class for a given set
-	// of fields is known as the "flyweight" design pattern
-	// and ensures that the memory needs of a program are kept
-	// down: rather than having a distinct type for every base
-	// INT (for example), only one is constructed and kept in
-	// the flyweights list. That type is then re-used anywhere
-	// it's needed. 
-
-	//Note the use of the static function declaration, which 
-	// means that no instance of BasicType is needed to call
-	// the function.
-	static BasicType * produce(BaseType base){
-		//Note the use of the static local variable, which
-		//means that the flyweights variable persists between
-		// multiple calls to this function (it is essentially
-		// a global variable that can only be accessed
-		// in this function).
-		static std::list<BasicType *> flyweights;
-		for(BasicType * fly : flyweights){
-			if (fly->getBaseType() == base){
-				return fly;
-			}
-		}
-		BasicType * newType = new BasicType(base);
-		flyweights.push_back(newType);
-		return newType;
-	}
 	const BasicType * asBasic() const override {
 		return this;
 	}
@@ -154,36 +112,19 @@ public:
 		else { return 0; }
 	}
 private:
+	friend class TypeContext;
 	BasicType(BaseType base) 
 	: myBaseType(base){ }
 	BaseType myBaseType;
 };
 
+//DataType subclass for pointers to a scalar type, at any
+// level of indirection. Pointer types are created (and
+// uniqued) by a TypeContext, which each one remembers so
+// that adding or removing a level of indirection stays
+// within the same context.
 class PtrType : public DataType{
 public:
-	static PtrType * produce(const BasicType * basicType, int level){
-		if (level <= 0){
-			throw new InternalError("bad pointer level");
-		}
-
-		//Note the use of the static local variable, which
-		//means that the flyweights variable persists between
-		// multiple calls to this function (it is essentially
-		// a global variable that can only be accessed
-		// in this function).
-		static std::list<PtrType *> flyweights;
-		for(PtrType * fly : flyweights){
-			if (fly->myBasicType == basicType){
-				if (fly->myLevel == level){
-					return fly;
-				}
-			}
-		}
-		PtrType * newType = new PtrType(basicType, level);
-		flyweights.push_back(newType);
-		return newType;
-	}
-
 	std::string getString() const override{
 		std::string res = myBasicType->getString();
 		for (int i = 0 ; i < myLevel ; i++){
@@ -193,23 +134,14 @@ public:
 	}
 
 	/* Add a level of indirection from a pointer type */
-	DataType * incLevel() const {
-		return PtrType::produce(myBasicType, myLevel + 1);
-	}
+	DataType * incLevel() const;
 
 	/* Remove a level of indirection to the pointer type */
-	const DataType * decLevel() const{
-		int newLevel = myLevel - 1;
-		if (newLevel == 0){
-			return myBasicType;
-		} else {
-			return PtrType::produce(myBasicType, newLevel);
-		}
-	}
+	const DataType * decLevel() const;
 
 	static const DataType * derefType(const DataType * type){
 		if (type->asError()){ 
-			return ErrorType::produce();
+			return type;
 		} else if (const PtrType * t = type->asPtr()){ 
 			return t->decLevel(); 
 		} else if (const BasicType * t = type->asBasic()){ 
@@ -219,48 +151,41 @@ public:
 		}
 	}
 
-	static DataType * refType(const DataType * type){
-		if (type->asError()){ 
-			return ErrorType::produce();
-		} else if (const PtrType * t = type->asPtr()){ 
-			return t->incLevel(); 
-		} else if (const BasicType * t = type->asBasic()){ 
-			return PtrType::produce(t, 1);
-		}
-		return nullptr;
-	}
+	static DataType * refType(TypeContext * types, 
+	  const DataType * type);
 
 	virtual bool validVarType() const override {
 		return true;
 	}
 	bool isPtr() const override { return true; } 
 	const PtrType * asPtr() const override { return this; }
-	int getLevel(){ return myLevel; }
+	const BasicType * getBasicType() const { return myBasicType; }
+	int getLevel() const { return myLevel; }
 	virtual size_t getSize() const override { return 8; }
 	
 private:
-	PtrType(const BasicType * basicType, int level)
-	: myBasicType(basicType), myLevel(level){
-		/* private constructor, can only be called from produce */
+	friend class TypeContext;
+	PtrType(TypeContext * context, 
+	  const BasicType * basicType, int level)
+	: myContext(context), myBasicType(basicType), myLevel(level){
+		/* private constructor, can only be called from 
+		 * TypeContext::ptr */
 	}
+	TypeContext * myContext;
 	const BasicType * myBasicType;
 	int myLevel;
 };
 
 //DataType subclass to represent the type of a function. It will
-// have a list of argument types and a return type. 
+// have a list of argument types and a return type. Function 
+// types are uniqued by a TypeContext like pointer types are,
+// so two functions with the same signature share one FnType.
 class FnType : public DataType{
 public:
-	FnType(const std::list<const DataType *>* formalsIn, const DataType * retTypeIn) 
-	: DataType(),
-	  myFormalTypes(formalsIn),
-	  myRetType(retTypeIn)
-	{
-	}
 	std::string getString() const override{
 		std::string result = "";
 		bool first = true;
-		for (auto elt : *myFormalTypes){
+		for (auto elt : myFormalTypes){
 			if (first) { first = false; }
 			else { result += ","; }
 			result += elt->getString();
@@ -274,16 +199,70 @@ public:
 	const DataType * getReturnType() const {
 		return myRetType;
 	}
-	const std::list<const DataType *> * getFormalTypes() const {
+	const std::vector<const DataType *>& getFormalTypes() const {
 		return myFormalTypes;
 	}
 	virtual bool validVarType() const override { return false; }
 	virtual size_t getSize() const override { return 0; }
 private:
-	const std::list<const DataType *> * myFormalTypes;
+	friend class TypeContext;
+	FnType(const std::vector<const DataType *>& formalsIn, 
+	  const DataType * retTypeIn) 
+	: DataType(),
+	  myFormalTypes(formalsIn),
+	  myRetType(retTypeIn)
+	{
+	}
+	const std::vector<const DataType *> myFormalTypes;
 	const DataType * myRetType;
 };
 
+//Owns every type used during a compilation. Each distinct
+// type is created exactly once: asking for a type that already
+// exists hands back the existing instance, so two types are
+// equal exactly when their pointers are, and looking up an
+// existing type allocates nothing. The scalar and error types
+// are made up front, as are the pointers to them, which are
+// the only pointer types a program can name or take the address
+// of. Nothing here is shared between contexts, so compilations
+// with their own contexts can run on separate threads. Within a
+// compilation, the types made later are locked; function types
+// are all made by the serial pass over the globals, so functions
+// analyzed in parallel never wait on the lock.
+class TypeContext{
+public:
+	TypeContext();
+	~TypeContext();
+	BasicType * basic(BaseType base){ return myBasics[base]; }
+	BasicType * VOID(){ return basic(BaseType::VOID); }
+	BasicType * BOOL(){ return basic(BaseType::BOOL); }
+	BasicType * CHAR(){ return basic(BaseType::CHAR); }
+	BasicType * INT(){ return basic(BaseType::INT); }
+	ErrorType * error(){ return myError; }
+	PtrType * ptr(const BasicType * base, int level);
+	FnType * fn(const std::vector<const DataType *>& formals,
+	  const DataType * retType);
+private:
+	TypeContext(const TypeContext&) = delete;
+	TypeContext& operator=(const TypeContext&) = delete;
+	static size_t fnHash(const std::vector<const DataType *>& formals,
+	  const DataType * retType);
+
+	//Indexed by BaseType
+	BasicType * myBasics[4];
+	//The single-level pointers, indexed by BaseType
+	PtrType * myPtrs[4];
+	ErrorType * myError;
+	//The deeper pointers, keyed by (base type, level) packed
+	// into one word
+	HashMap<uint64_t, PtrType *> ptrTypes;
+	//Keyed by signature hash; collisions are told apart by
+	// comparing the signatures themselves
+	std::unordered_multimap<size_t, FnType *> fnTypes;
+	//Guards ptrTypes and fnTypes
+	std::mutex lock;
+};
+
 }
 
 #endif
@@ -1,6 +1,9 @@
+#include <exception>
 #include <iterator> 
+#include <vector>
 
 #include "ast.hpp"
+#include "parallel.hpp"
 
 #define MAKEBINOP(OPERATOR) \
 	Opd* tmp1 = myExp1->flatten(proc);\
@@ -26,29 +29,64 @@
 	return dst;
 
 #define MAKELITOPD(VALUE, TYPE)\
-	return new LitOpd(VALUE, TYPE);
+	return proc->makeLit(VALUE, TYPE);
 
 //#define MAKEINTRINSICQUAD(TYPE, OP)
 	//return new LitOpd
 
 namespace holeyc{
 
-IRProgram * ProgramNode::to3AC(TypeAnalysis * ta){
-	IRProgram * prog = new IRProgram(ta);
-	for (auto global : *myGlobals){
-		global->to3AC(prog);
+IRProgram * ProgramNode::to3AC(TypeAnalysis * ta, size_t threads){
+	IRProgram * prog = new IRProgram(ta, threads);
+	//The globals and procedures are laid out in order, then the
+	// procedures are filled in side by side. If laying out a
+	// declaration throws, the functions before it are still
+	// lowered first, since they would have thrown first.
+	std::vector<std::pair<FnDeclNode *, Procedure *>> bodies;
+	std::exception_ptr layoutError;
+	try {
+		for (auto global : *myGlobals){
+			FnDeclNode * fn = global->asFnDecl();
+			if (fn == nullptr){
+				global->to3AC(prog);
+			} else if (Procedure * proc = fn->makeProc(prog)){
+				bodies.push_back(std::make_pair(fn, proc));
+			}
+		}
+	} catch (...){
+		layoutError = std::current_exception();
 	}
+	parallelFor(bodies.size(), threads, [&](size_t i){
+		bodies[i].first->lowerBody(bodies[i].second);
+	});
+	if (layoutError){ std::rethrow_exception(layoutError); }
 	return prog;
 }
 
 void FnDeclNode::to3AC(IRProgram * prog){
-    Procedure *p  = prog->makeProc(myID->getName()); 
+	if (Procedure * p = makeProc(prog)){
+		lowerBody(p);
+	}
+}
+
+Procedure * FnDeclNode::makeProc(IRProgram * prog){
+	if (const ProcTemplate * reused = prog->reusedProc(this)){
+		prog->spliceProc(myID->getName(), reused)->setDecl(this);
+		return nullptr;
+	}
+	Procedure * p = prog->makeProc(myID->getName());
+	p->setDecl(this);
+	return p;
+}
+
+void FnDeclNode::lowerBody(Procedure * p){
+	IRProgram * prog = p->getProg();
     for (auto child : *myFormals) {
 		child->to3AC(p);
 		p->addQuad(
 				new GetArgQuad(
 					static_cast<size_t>(std::distance(*myFormals->begin(), child))
-					, p->getSymOpd(child->ID()->getSymbol())
+					, p->getSymOpd(prog->symbolOf(child->ID()))
 					)
 				);
 	}
@@ -66,32 +104,36 @@ void FormalDeclNode::to3AC(IRProgram * prog){
 }
 
 void FormalDeclNode::to3AC(Procedure * proc){
-	proc->gatherFormal(myID->getSymbol());
+	SemSymbol * sym = proc->getProg()->symbolOf(myID);
+	if (sym == nullptr){
+		throw new InternalError("null sym");
+	}
+	proc->gatherFormal(sym);
 }
 
 Opd * IntLitNode::flatten(Procedure * proc){
-	MAKELITOPD(std::to_string(myNum), QUADWORD);
+	MAKELITOPD(myNum, QUADWORD);
 }
 
 Opd * StrLitNode::flatten(Procedure * proc){
-	Opd * res = proc->getProg()->makeString(myStr);
+	Opd * res = proc->makeString(myStr);
 	return res;
 }
 
 Opd * CharLitNode::flatten(Procedure * proc){
-	MAKELITOPD(std::to_string(myVal), BYTE);
+	MAKELITOPD(myVal, BYTE);
 }
 
 Opd * NullPtrNode::flatten(Procedure * proc){
-	MAKELITOPD("0", ADDR);
+	MAKELITOPD(0, ADDR);
 }
 
-Opd * TrueNode::flatten(Procedure * prog){
-	MAKELITOPD("1", BYTE);
+Opd * TrueNode::flatten(Procedure * proc){
+	MAKELITOPD(1, BYTE);
 }
 
-Opd * FalseNode::flatten(Procedure * prog){
-	MAKELITOPD("0", BYTE);
+Opd * FalseNode::flatten(Procedure * proc){
+	MAKELITOPD(0, BYTE);
 }
 
 Opd * AssignExpNode::flatten(Procedure * proc){
@@ -121,7 +163,7 @@ Opd * CallExpNode::flatten(Procedure * proc){
         index++;
         proc->addQuad(a);
     }
-    SymOpd * sym = proc->getSymOpd(myID->getSymbol());
+    SymOpd * sym = proc->getSymOpd(proc->getProg()->symbolOf(myID));
     return sym;
 }
 
@@ -238,7 +280,7 @@ void ReturnStmtNode::to3AC(Procedure * proc){
 }
 
 void VarDeclNode::to3AC(Procedure * proc){
-	SemSymbol * sym = ID()->getSymbol();
+	SemSymbol * sym = proc->getProg()->symbolOf(ID());
 	if (sym == nullptr){
 		throw new InternalError("null sym");
 	}
@@ -246,7 +288,7 @@ void VarDeclNode::to3AC(Procedure * proc){
 }
 
 void VarDeclNode::to3AC(IRProgram * prog){
-	SemSymbol * sym = ID()->getSymbol();
+	SemSymbol * sym = prog->symbolOf(ID());
 	if (sym == nullptr){
 		throw new InternalError("null sym");
 	}
@@ -257,7 +299,7 @@ void VarDeclNode::to3AC(IRProgram * prog){
 //We only get to this node if we are in a stmt
 // context (DeclNodes protect descent) 
 Opd * IDNode::flatten(Procedure * proc){
-	return proc->getSymOpd(this->getSymbol());	
+	return proc->getSymOpd(proc->getProg()->symbolOf(this));	
 }
 
 
@@ -8,15 +8,102 @@ Procedure::Procedure(IRProgram * prog, std::string name)
 	enter = new EnterQuad(this);
 	leave = new LeaveQuad(this);
 	if (myName.compare("main") == 0){
-		enter->addLabel(new Label("main"));
+		labels.push_back(new Label("main"));
 	} else {
-		enter->addLabel(new Label("fun_" + myName));
+		labels.push_back(new Label("fun_" + myName));
 	}
-	leaveLabel = myProg->makeLabel();
+	enter->addLabel(labels.back());
+	leaveLabel = makeLabel();
 	leave->addLabel(leaveLabel);
 }
 
-std::string Procedure::getName(){
+Procedure::Procedure(IRProgram * prog, std::string name,
+  const ProcTemplate * templateIn)
+: enter(nullptr), leave(nullptr), leaveLabel(nullptr),
+  myProg(prog), myName(name), maxTmp(0),
+  labelCount(templateIn->labels), strings(templateIn->strings),
+  spliced(templateIn){
+}
+
+Procedure::~Procedure(){
+	delete enter;
+	delete leave;
+	for (Quad * quad : bodyQuads){ delete quad; }
+	for (SymOpd * formal : formals){ delete formal; }
+	for (SymOpd * local : localOrder){ delete local; }
+	for (AuxOpd * tmp : temps){ delete tmp; }
+	for (LitOpd * lit : literals){ delete lit; }
+	for (StrOpd * str : strOpds){ delete str; }
+	for (Label * label : labels){ delete label; }
+}
+
+ProcTemplate Procedure::toTemplate(){
+	ProcTemplate res;
+	res.labels = labelCount;
+	res.strings = strings;
+	templating = true;
+	res.text = toString(false);
+	templating = false;
+	return res;
+}
+
+void Procedure::emitLabel(Emitter& out, size_t num){
+	if (templating){
+		out << ProcTemplate::LABEL_MARK << num << ProcTemplate::END_MARK;
+		return;
+	}
+	if (!numbered){
+		throw new InternalError("Label of an unnumbered procedure");
+	}
+	out << "lbl_" << (labelBase + num);
+}
+
+void Procedure::emitStr(Emitter& out, size_t num){
+	if (templating){
+		out << ProcTemplate::STR_MARK << num << ProcTemplate::END_MARK;
+		return;
+	}
+	if (!numbered){
+		throw new InternalError("String of an unnumbered procedure");
+	}
+	out << "str_" << (strBase + num);
+}
+
+//Fill in the template's markers with the procedure's numbers
+static void instantiate(const ProcTemplate * tmpl, Procedure * proc,
+  Emitter& out){
+	static const char marks[] = {
+		ProcTemplate::LABEL_MARK, ProcTemplate::STR_MARK, '\0' };
+	const std::string& text = tmpl->text;
+	size_t pos = 0;
+	while (pos < text.size()){
+		size_t mark = text.find_first_of(marks, pos);
+		if (mark == std::string::npos){
+			out.put(text.data() + pos, text.size() - pos);
+			break;
+		}
+		out.put(text.data() + pos, mark - pos);
+		size_t end = text.find(ProcTemplate::END_MARK, mark);
+		if (end == std::string::npos || end == mark + 1){
+			throw new InternalError("Bad procedure template");
+		}
+		size_t num = 0;
+		for (size_t i = mark + 1; i < end; i++){
+			if (text[i] < '0' || text[i] > '9'){
+				throw new InternalError("Bad procedure template");
+			}
+			num = num * 10 + static_cast<size_t>(text[i] - '0');
+		}
+		if (text[mark] == ProcTemplate::LABEL_MARK){
+			proc->emitLabel(out, num);
+		} else {
+			proc->emitStr(out, num);
+		}
+		pos = end + 1;
+	}
+}
+
+const std::string& Procedure::getName(){
 	return myName;
 }
 
@@ -26,33 +113,49 @@ Label * Procedure::getLeaveLabel(){
 
 IRProgram * Procedure::getProg(){ return myProg; }
 
-std::string Procedure::toString(bool verbose){
-	std::string res = "";
+void Procedure::emit(Emitter& out, bool verbose){
+	if (spliced != nullptr){
+		instantiate(spliced, this, out);
+		return;
+	}
 
-	res += "[BEGIN " + this->getName() + " LOCALS]\n";
+	out << "[BEGIN " << this->getName() << " LOCALS]\n";
 	for (const auto formal : this->formals){
-		res += formal->toString() + " (formal)\n";
+		formal->emit(out);
+		out << " (formal)\n";
 	}
 
-	for (auto local : this->locals){
-		res += local.second->toString() + " (local)\n";
+	for (auto local : this->localOrder){
+		local->emit(out);
+		out << " (local)\n";
 	}
 
 	for (auto tmp : temps){
-		res += tmp->toString() + " (tmp)\n";
+		tmp->emit(out);
+		out << " (tmp)\n";
 	}
-	res += "[END " + this->getName() + " LOCALS]\n";
+	out << "[END " << this->getName() << " LOCALS]\n";
 
-	res += enter->toString(verbose) + "\n";
+	enter->emit(out, verbose);
+	out << '\n';
 	for (auto quad : bodyQuads){
-		res += quad->toString(verbose) + "\n";
+		quad->emit(out, verbose);
+		out << '\n';
 	}
-	res += leave->toString(verbose) + "\n";
+	leave->emit(out, verbose);
+	out << '\n';
+}
+
+std::string Procedure::toString(bool verbose){
+	std::string res;
+	Emitter out(res);
+	emit(out, verbose);
 	return res;
 }
 
 Label * Procedure::makeLabel(){
-	return myProg->makeLabel();
+	labels.push_back(new Label(this, labelCount++));
+	return labels.back();
 }
 
 void Procedure::addQuad(Quad * quad){
@@ -66,8 +169,11 @@ Quad * Procedure::popQuad(){
 }
 
 void Procedure::gatherLocal(SemSymbol * sym){
+	if (locals.find(sym) != locals.end()){ return; }
 	OpdWidth width = Opd::width(sym->getDataType());
-	locals[sym] = new SymOpd(sym, width);
+	SymOpd * opd = new SymOpd(sym, width);
+	locals[sym] = opd;
+	localOrder.push_back(opd);
 }
 
 void Procedure::gatherFormal(SemSymbol * sym){
@@ -99,4 +205,17 @@ AuxOpd * Procedure::makeTmp(OpdWidth width){
 	return res;
 }
 
+Opd * Procedure::makeString(std::string val){
+	StrOpd * opd = new StrOpd(this, strings.size());
+	strings.push_back(val);
+	strOpds.push_back(opd);
+	return opd;
+}
+
+LitOpd * Procedure::makeLit(long long val, OpdWidth width){
+	LitOpd * res = new LitOpd(val, width);
+	literals.push_back(res);
+	return res;
+}
+
 }
@@ -1,6 +1,8 @@
 #include "3ac.hpp"
 #include "vector"
+#include <algorithm>
 #include "type_analysis.hpp"
+#include "parallel.hpp"
 
 namespace holeyc {
 
@@ -14,9 +16,36 @@ OpdWidth IRProgram::opWidth(ASTNode * node){
 	return Opd::width(ta->nodeType(node));
 }
 
-Label * IRProgram::makeLabel(){
-	Label * label = new Label(std::to_string(max_label++));
-	return label;
+SemSymbol * IRProgram::symbolOf(const IDNode * id){
+	return ta->symbolOf(id);
+}
+
+const char ProcTemplate::LABEL_MARK;
+const char ProcTemplate::STR_MARK;
+const char ProcTemplate::END_MARK;
+
+Procedure * IRProgram::spliceProc(std::string name,
+  const ProcTemplate * tmpl){
+	Procedure * proc = new Procedure(this, name, tmpl);
+	procs.push_back(proc);
+	return proc;
+}
+
+const ProcTemplate * IRProgram::reusedProc(const ASTNode * fn){
+	return ta->reusedProc(fn);
+}
+
+void IRProgram::numberProcs(){
+	for (Procedure * proc : procs){
+		if (proc->numbered){ continue; }
+		proc->labelBase = max_label;
+		max_label += proc->labelCount;
+		proc->strBase = str_idx;
+		str_idx += proc->strings.size();
+		strings.insert(strings.end(), proc->strings.begin(),
+		  proc->strings.end());
+		proc->numbered = true;
+	}
 }
 
 SymOpd * IRProgram::getGlobal(SemSymbol * sym){
@@ -27,36 +56,96 @@ SymOpd * IRProgram::getGlobal(SemSymbol * sym){
 }
 
 void IRProgram::gatherGlobal(SemSymbol * sym){
+	if (globals.find(sym) != globals.end()){ return; }
 	OpdWidth width = Opd::width(sym->getDataType());
 	SymOpd * res = new SymOpd(sym, width);
 	globals[sym] = res;
+	globalOrder.push_back(res);
 }
 
-Opd * IRProgram::makeString(std::string val){
-	std::string name = "str_" + std::to_string(str_idx++);
-	AuxOpd * opd = new AuxOpd(name, ADDR);
-	strings[opd] = val;
-	return opd;
+void Label::emit(Emitter& out){
+	if (proc != nullptr){
+		proc->emitLabel(out, num);
+		return;
+	}
+	out << "lbl_" << this->name;
 }
 
-std::string IRProgram::toString(bool verbose){
-	std::string res = "";
-	res += "[BEGIN GLOBALS]\n";
-	for (auto entry : globals){
-		res += entry.second->toString() + "\n"; 
+std::string Label::toString(){
+	std::string res;
+	Emitter out(res);
+	emit(out);
+	return res;
+}
+
+std::string Opd::toString(){
+	std::string res;
+	Emitter out(res);
+	emit(out);
+	return res;
+}
+
+void StrOpd::emit(Emitter& out){
+	proc->emitStr(out, num);
+}
+
+//Procedures rendered side by side at a time, which bounds how
+// much rendered text is held before it is written out
+static const size_t RENDER_BATCH = 256;
+
+void IRProgram::emit(Emitter& out, bool verbose){
+	emitGlobals(out);
+	if (threads == 1){
+		for (Procedure * proc : procs){
+			proc->emit(out, verbose);
+		}
+		return;
 	}
-	for (auto entry : strings){
-		res += entry.first->toString(); 
-		res += " " + entry.second; 
-		res += "\n";
+	//Each procedure of a batch is rendered on its own, then the
+	// batch is written out in order
+	std::vector<Procedure *> order(procs.begin(), procs.end());
+	std::vector<std::string> texts;
+	for (size_t start = 0; start < order.size(); start += RENDER_BATCH){
+		size_t count = std::min(RENDER_BATCH, order.size() - start);
+		texts.assign(count, std::string());
+		parallelFor(count, threads, [&](size_t i){
+			Emitter text(texts[i]);
+			order[start + i]->emit(text, verbose);
+		});
+		for (const std::string& text : texts){
+			out << text;
+		}
 	}
+}
+
+std::string IRProgram::toString(bool verbose){
+	std::string res;
+	Emitter out(res);
+	emit(out, verbose);
+	return res;
+}
 
-	res += "[END GLOBALS]\n";
-	
+void IRProgram::flushProcs(Emitter& out, bool verbose){
+	numberProcs();
 	for (Procedure * proc : procs){
-		res += proc->toString(verbose);
+		proc->emit(out, verbose);
+		delete proc;
 	}
-	return res;
+	procs.clear();
+}
+
+void IRProgram::emitGlobals(Emitter& out){
+	numberProcs();
+	out << "[BEGIN GLOBALS]\n";
+	for (auto global : globalOrder){
+		global->emit(out);
+		out << '\n';
+	}
+	for (size_t i = 0; i < strings.size(); i++){
+		out << "str_" << i << ' ' << strings[i] << '\n';
+	}
+
+	out << "[END GLOBALS]\n";
 }
 
 }
@@ -14,63 +14,60 @@ void Quad::setComment(std::string commentIn){
 	this->myComment = commentIn;
 }
 
-std::string Quad::commentStr(){
-	if (myComment.length() > 0){
-		return "  #" + myComment;
-	}
-	return "";
-}
-
-std::string Quad::toString(bool verbose){
-	auto res = std::string("");
-
+void Quad::emit(Emitter& out, bool verbose){
 	auto first = true;
 	for (auto label : labels){
 		if (first){ first = false; }
-		else { res += ","; }
+		else { out << ','; }
 
-		res += label->toString();
+		label->emit(out);
 	}
-	if (!first){ res += ": "; }
+	if (!first){ out << ": "; }
 
-	res += this->repr();
-	if (verbose){
-		res += commentStr();
+	this->repr(out);
+	if (verbose && myComment.length() > 0){
+		out << "  #" << myComment;
 	}
+}
 
+std::string Quad::toString(bool verbose){
+	std::string res;
+	Emitter out(res);
+	emit(out, verbose);
 	return res;
 }
 
 CallQuad::CallQuad(SemSymbol * calleeIn) : callee(calleeIn){ }
 
-std::string CallQuad::repr(){
-	return "call " + callee->getName();
+void CallQuad::repr(Emitter& out){
+	out << "call " << callee->getName();
 }
 
 EnterQuad::EnterQuad(Procedure * procIn) : Quad(), myProc(procIn)
 { }
 
-std::string EnterQuad::repr(){
-	return "enter " + myProc->getName();
+void EnterQuad::repr(Emitter& out){
+	out << "enter " << myProc->getName();
 }
 
 LeaveQuad::LeaveQuad(Procedure * procIn) : Quad(), myProc(procIn)
 { }
 
-std::string LeaveQuad::repr(){
-	return "leave " + myProc->getName();
+void LeaveQuad::repr(Emitter& out){
+	out << "leave " << myProc->getName();
 }
 
-std::string AssignQuad::repr(){
-	return dst->toString() + " := " + src->toString();
-	
+void AssignQuad::repr(Emitter& out){
+	dst->emit(out);
+	out << " := ";
+	src->emit(out);
 }
 
 BinOpQuad::BinOpQuad(Opd * dstIn, BinOp opIn, Opd * src1In, Opd * src2In)
 : dst(dstIn), op(opIn), src1(src1In), src2(src2In){ }
 
-std::string BinOpQuad::repr(){
-	std::string opString;
+void BinOpQuad::repr(Emitter& out){
+	const char * opString = "";
 	switch (op){
 	case ADD:
 		opString = " ADD64 ";
@@ -117,17 +114,18 @@ std::string BinOpQuad::repr(){
 		opString = " GTE64 ";
 		break;
 	}
-	return dst->toString() + " := " 
-		+ src1->toString()
-		+ opString
-		+ src2->toString();
+	dst->emit(out);
+	out << " := ";
+	src1->emit(out);
+	out << opString;
+	src2->emit(out);
 }
 
 UnaryOpQuad::UnaryOpQuad(Opd * dstIn, UnaryOp opIn, Opd * srcIn)
 : dst(dstIn), op(opIn), src(srcIn) { }
 
-std::string UnaryOpQuad::repr(){
-	std::string opString;
+void UnaryOpQuad::repr(Emitter& out){
+	const char * opString = "";
 	switch (op){
 	case NEG:
 		opString = "NEG64 ";
@@ -135,90 +133,84 @@ std::string UnaryOpQuad::repr(){
 	case NOT:
 		opString = "NOT8 ";
 	}
-	return dst->toString() + " := " 
-		+ opString
-		+ src->toString();
+	dst->emit(out);
+	out << " := " << opString;
+	src->emit(out);
 }
 
 IntrinsicQuad::IntrinsicQuad(Intrinsic intrinsic, Opd * opd) 
 : myArg(opd), myIntrinsic(intrinsic){ }
 
-std::string IntrinsicQuad::repr(){
-	std::string res;
+void IntrinsicQuad::repr(Emitter& out){
 	switch (myIntrinsic){
 	case INPUT:
-		res = "INPUT " + myArg->toString();
+		out << "INPUT ";
 		break;
 	case OUTPUT:
-		res = "OUTPUT " + myArg->toString();
+		out << "OUTPUT ";
 		break;
 	}
-	return res;
+	myArg->emit(out);
 }
 
 JmpQuad::JmpQuad(Label * tgtIn)
 : Quad(), tgt(tgtIn){ }
 
-std::string JmpQuad::repr(){
-	std::string res = "";
-	return "goto " + tgt->toString();
+void JmpQuad::repr(Emitter& out){
+	out << "goto ";
+	tgt->emit(out);
 }
 
 JmpIfQuad::JmpIfQuad(Opd * cndIn, Label * tgtIn) 
 : Quad(), cnd(cndIn), tgt(tgtIn){ }
 
-std::string JmpIfQuad::repr(){
-	std::string res = "IFZ ";
-	res += cnd->toString();
-	res += " GOTO ";
-	res += tgt->toString();
-	return res;
+void JmpIfQuad::repr(Emitter& out){
+	out << "IFZ ";
+	cnd->emit(out);
+	out << " GOTO ";
+	tgt->emit(out);
 }
 
 NopQuad::NopQuad()
 : Quad() { }
 
-std::string NopQuad::repr(){
-	return "nop";
+void NopQuad::repr(Emitter& out){
+	out << "nop";
 }
 
 GetRetQuad::GetRetQuad(Opd * opdIn)
-: Quad(), opd(opdIn) { }
+: Quad(), index(0), opd(opdIn) { }
 
-std::string GetRetQuad::repr(){
-	std::string res = "";
-	res += "getret " + opd->toString(); 
-	return res;
+void GetRetQuad::repr(Emitter& out){
+	out << "getret ";
+	opd->emit(out);
 }
 
 SetArgQuad::SetArgQuad(size_t indexIn, Opd * opdIn) 
 : index(indexIn), opd(opdIn){
 }
 
-std::string SetArgQuad::repr(){
-	std::string res = "";
-	res += "setarg " + std::to_string(index) + " " + opd->toString(); 
-	return res;
+void SetArgQuad::repr(Emitter& out){
+	out << "setarg " << index << ' ';
+	opd->emit(out);
 }
 
 GetArgQuad::GetArgQuad(size_t indexIn, Opd * opdIn) 
 : index(indexIn), opd(opdIn){
 }
 
-std::string GetArgQuad::repr(){
-	std::string res = "";
-	res += "getarg " + std::to_string(index) + " " + opd->toString(); 
-	return res;
+void GetArgQuad::repr(Emitter& out){
+	out << "getarg " << index << ' ';
+	opd->emit(out);
 }
 
 SetRetQuad::SetRetQuad(Opd * opdIn) 
-: opd(opdIn){
+: index(0), opd(opdIn){
 }
 
-std::string SetRetQuad::repr(){
-	std::string res = "";
-	res += "setret " + std::to_string(index) + " " + opd->toString(); 
-	return res;
+void SetRetQuad::repr(Emitter& out){
+	out << "setret " << index << ' ';
+	opd->emit(out);
 }
 
 }
@@ -0,0 +1,78 @@
+#include <cstdint>
+
+#include "arena.hpp"
+
+namespace holeyc{
+
+Arena::Arena(size_t blockSizeIn) : blockSize(blockSizeIn){
+}
+
+Arena::~Arena(){
+	runCleanups();
+	while (head != nullptr){
+		Block * prev = head->prev;
+		::operator delete(head);
+		head = prev;
+	}
+}
+
+char * Arena::newBlock(size_t minSize){
+	size_t size = blockSize;
+	if (minSize > size){ size = minSize; }
+	void * raw = ::operator new(sizeof(Block) + size);
+	Block * block = static_cast<Block *>(raw);
+	block->prev = head;
+	block->size = size;
+	head = block;
+	char * data = static_cast<char *>(raw) + sizeof(Block);
+	limit = data + size;
+	return data;
+}
+
+void * Arena::allocate(size_t size, size_t align){
+	uintptr_t at = reinterpret_cast<uintptr_t>(cursor);
+	uintptr_t aligned = (at + align - 1) & ~(align - 1);
+	if (cursor == nullptr 
+	  || aligned + size > reinterpret_cast<uintptr_t>(limit)){
+		cursor = newBlock(size + align);
+		at = reinterpret_cast<uintptr_t>(cursor);
+		aligned = (at + align - 1) & ~(align - 1);
+	}
+	char * res = cursor + (aligned - at);
+	cursor = res + size;
+	used += size;
+	return res;
+}
+
+void Arena::addCleanup(void (*fn)(void *), void * obj){
+	Cleanup * entry = static_cast<Cleanup *>(
+		allocate(sizeof(Cleanup), alignof(Cleanup)));
+	entry->fn = fn;
+	entry->obj = obj;
+	entry->next = cleanups;
+	cleanups = entry;
+}
+
+void Arena::runCleanups(){
+	while (cleanups != nullptr){
+		Cleanup * next = cleanups->next;
+		cleanups->fn(cleanups->obj);
+		cleanups = next;
+	}
+}
+
+void Arena::reset(){
+	runCleanups();
+	if (head == nullptr){ return; }
+	//Keep only the oldest block
+	while (head->prev != nullptr){
+		Block * prev = head->prev;
+		::operator delete(head);
+		head = prev;
+	}
+	cursor = reinterpret_cast<char *>(head) + sizeof(Block);
+	limit = cursor + head->size;
+	used = 0;
+}
+
+}
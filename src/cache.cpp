@@ -0,0 +1,78 @@
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cache.hpp"
+
+namespace holeyc{
+
+//The Makefile sets this to a checksum of the sources the
+// library was built from
+#ifndef HOLEYC_BUILD_ID
+#define HOLEYC_BUILD_ID "unknown"
+#endif
+
+const std::string& compilerID(){
+	static const std::string id =
+	  std::string(CACHE_FORMAT) + " " + HOLEYC_BUILD_ID;
+	return id;
+}
+
+std::string OutputCache::key(const char * data, size_t size,
+  const std::string& options){
+	Digest digest;
+	digest.add(compilerID());
+	digest.add(options);
+	uint64_t len = size;
+	digest.add(reinterpret_cast<const char *>(&len), sizeof(len));
+	digest.add(data, size);
+	return digest.hex();
+}
+
+//Entries are spread over subdirectories named by the first two
+// digits of their key, to keep directories small
+std::string OutputCache::pathOf(const std::string& keyIn,
+  const char * ext) const {
+	return dir + "/" + keyIn.substr(0, 2) + "/" + keyIn.substr(2) + ext;
+}
+
+bool OutputCache::lookup(const std::string& keyIn, std::string& out,
+  const char * ext) const {
+	std::ifstream in(pathOf(keyIn, ext), std::ios::binary);
+	if (!in.good()){ return false; }
+	std::ostringstream text;
+	text << in.rdbuf();
+	if (in.bad()){ return false; }
+	out = text.str();
+	return true;
+}
+
+void OutputCache::store(const std::string& keyIn,
+  const std::string& text, const char * ext) const {
+	mkdir(dir.c_str(), 0777);
+	std::string subdir = dir + "/" + keyIn.substr(0, 2);
+	mkdir(subdir.c_str(), 0777);
+
+	std::ostringstream tmpName;
+	tmpName << subdir << "/.tmp." << getpid() << "."
+	  << std::this_thread::get_id();
+	std::string tmpPath = tmpName.str();
+	{
+		std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+		out << text;
+		out.close();
+		if (!out.good()){
+			unlink(tmpPath.c_str());
+			return;
+		}
+	}
+	if (rename(tmpPath.c_str(), pathOf(keyIn, ext).c_str()) != 0){
+		unlink(tmpPath.c_str());
+	}
+}
+
+}
@@ -0,0 +1,118 @@
+#include <cstring>
+
+#include "chunked_lexer.hpp"
+#include "fast_scanner.hpp"
+#include "parallel.hpp"
+
+namespace holeyc{
+
+//Pieces are no smaller than this, so that small inputs are
+// lexed in one go and big ones aren't split finer than the
+// merging is worth
+static const size_t MIN_CHUNK_BYTES = 1 << 20;
+//Pieces per thread, so that a thread that finishes early can
+// pick up more
+static const size_t CHUNKS_PER_THREAD = 4;
+
+struct ChunkedLexer::Chunk{
+	Chunk(const SourceManager * src, SrcOffset beginIn, SrcOffset endIn)
+	: begin(beginIn), end(endIn), errors(src){ }
+	SrcOffset begin;
+	SrcOffset end;
+	Arena arena;
+	StringInterner names;
+	LexErrors errors;
+	std::vector<LexedToken> tokens;
+	//What each of names is in the context's interner
+	std::vector<Ident> globalNames;
+};
+
+ChunkedLexer::ChunkedLexer(CompilationContext * ctxIn, size_t threadsIn)
+: ctx(ctxIn), threads(threadsIn){
+}
+
+ChunkedLexer::~ChunkedLexer(){
+}
+
+bool ChunkedLexer::splits(size_t inputSize){
+	return inputSize / MIN_CHUNK_BYTES > 1;
+}
+
+void ChunkedLexer::lexAll(std::vector<LexedToken>& tokens,
+  Arena * tokenArena, LexErrors& errors){
+	const SourceManager * src = ctx->source();
+	size_t size = src->size();
+	size_t count = workerCount(threads, size) * CHUNKS_PER_THREAD;
+	if (count > size / MIN_CHUNK_BYTES){ count = size / MIN_CHUNK_BYTES; }
+	if (count <= 1){
+		FastScanner(ctx, tokenArena).lexAll(tokens, errors);
+		return;
+	}
+
+	//Cut just after the first newline at or past each even split
+	const char * data = src->data();
+	size_t begin = 0;
+	for (size_t i = 1; i <= count && begin < size; i++){
+		size_t end = size;
+		if (i < count){
+			size_t split = size / count * i;
+			if (split < begin){ split = begin; }
+			const void * nl = memchr(data + split, '\n', size - split);
+			if (nl != nullptr){
+				end = static_cast<size_t>(static_cast<const char *>(nl) - data) + 1;
+			}
+		}
+		chunks.emplace_back(new Chunk(src, static_cast<SrcOffset>(begin),
+		  static_cast<SrcOffset>(end)));
+		begin = end;
+	}
+
+	parallelFor(chunks.size(), threads, [&](size_t i){
+		Chunk& chunk = *chunks[i];
+		FastScanner scanner(&chunk.names, chunk.errors.sink(), src,
+		  &chunk.arena, chunk.begin, chunk.end);
+		scanner.lexAll(chunk.tokens, chunk.errors);
+		//Only the last piece ends where the input does. An error
+		// found lexing the END of another piece was found before
+		// the first token of the next one
+		chunk.tokens.pop_back();
+	});
+
+	//In input order, as they would have come up
+	size_t base = tokens.size();
+	for (std::unique_ptr<Chunk>& chunk : chunks){
+		for (size_t i = 0; i < chunk->errors.size(); i++){
+			errors.add(base + chunk->errors.tokenAt(i), chunk->errors.at(i));
+		}
+		base += chunk->tokens.size();
+		chunk->globalNames.reserve(chunk->names.size());
+		for (NameID id = 0; id < chunk->names.size(); id++){
+			chunk->globalNames.push_back(
+			  ctx->names.intern(chunk->names.get(id).text()));
+		}
+	}
+
+	parallelFor(chunks.size(), threads, [&](size_t i){
+		Chunk& chunk = *chunks[i];
+		for (LexedToken& tok : chunk.tokens){
+			if (tok.kind != Parser::token::ID){ continue; }
+			IDToken * local = static_cast<IDToken *>(tok.token);
+			tok.token = chunk.arena.make<IDToken>(local->offset(),
+			  chunk.globalNames[local->value().id()]);
+		}
+	});
+
+	size_t total = 1;
+	for (std::unique_ptr<Chunk>& chunk : chunks){
+		total += chunk->tokens.size();
+	}
+	tokens.reserve(tokens.size() + total);
+	for (std::unique_ptr<Chunk>& chunk : chunks){
+		tokens.insert(tokens.end(), chunk->tokens.begin(), chunk->tokens.end());
+	}
+	Token * eof = tokenArena->make<Token>(static_cast<SrcOffset>(size),
+	  Parser::token::END);
+	tokens.push_back(LexedToken{Parser::token::END, eof});
+}
+
+}
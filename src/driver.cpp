@@ -0,0 +1,316 @@
+#include <fstream>
+#include <string.h>
+
+#include "driver.hpp"
+#include "cache.hpp"
+#include "emitter.hpp"
+#include "errors.hpp"
+#include "parallel.hpp"
+#include "scanner.hpp"
+#include "stream.hpp"
+
+namespace holeyc{
+
+std::ostream * OutputFiles::open(const char * path){
+	if (strcmp(path, "--") == 0){ return &std::cout; }
+	if (file.is_open()){ file.close(); }
+	file.clear();
+	file.open(path);
+	if (!file.good()){ return nullptr; }
+	return &file;
+}
+
+static std::ostream& openOrDie(OutputFiles& outputs, const char * outPath){
+	std::ostream * out = outputs.open(outPath);
+	if (out == nullptr){
+		std::string msg = "Bad output file ";
+		msg += outPath;
+		throw new InternalError(msg.c_str());
+	}
+	return *out;
+}
+
+static void outputTokens(CompilationSession * session,
+  const char * outPath, OutputFiles& outputs){
+	const std::vector<LexedToken> * tokens = session->tokens();
+	Scanner::outputTokens(*tokens, *session->sourceManager(),
+	  openOrDie(outputs, outPath));
+}
+
+static void outputTokenFile(CompilationSession * session,
+  const char * outPath, OutputFiles& outputs){
+	const std::vector<LexedToken> * tokens = session->tokens();
+	TokenFile::write(*tokens, *session->lexErrors(),
+	  *session->sourceManager(), openOrDie(outputs, outPath));
+}
+
+static void outputAST(ASTNode * ast, const char * outPath,
+  OutputFiles& outputs){
+	ast->unparse(openOrDie(outputs, outPath), 0);
+}
+
+static bool doUnparsing(CompilationSession * session,
+  const char * outPath, std::ostream& err, OutputFiles& outputs){
+	ProgramNode * ast = session->ast();
+	if (ast == nullptr){
+		err << "No AST built\n";
+		return false;
+	}
+
+	outputAST(ast, outPath, outputs);
+	return true;
+}
+
+static void write3AC(IRProgram * prog, const char * outPath,
+  OutputFiles& outputs){
+	if (outPath == nullptr){
+		throw new InternalError("Null 3AC file given");
+	}
+	std::ostream& out = openOrDie(outputs, outPath);
+	//Rendered straight onto the stream, a buffer at a time
+	Emitter emitter(out);
+	prog->emit(emitter);
+	emitter << '\n';
+	emitter.flush();
+	out.flush();
+}
+
+int runSession(CompilationSession * session,
+  const DriverOptions& opts, std::ostream& err){
+	OutputFiles outputs;
+	return runSession(session, opts, err, outputs);
+}
+
+bool cacheable(const DriverOptions& opts){
+	return opts.cacheDir != nullptr && opts.threeACFile != nullptr
+	  && opts.tokensFile == nullptr && opts.tokenFileOut == nullptr
+	  && opts.unparseFile == nullptr
+	  && opts.nameFile == nullptr;
+}
+
+std::string cacheOptions(const DriverOptions& opts){
+	std::string res = "a";
+	if (opts.checkParse){ res += "p"; }
+	if (opts.checkTypes){ res += "c"; }
+	return res;
+}
+
+//Serve the 3AC from the cache, or compile it and store it there.
+// Only runs that printed nothing besides the 3AC are stored, so
+// a hit never leaves out a warning. On a miss, the functions
+// that haven't changed since they were last stored are spliced
+// in from the same cache rather than compiled again.
+static int runCached(CompilationSession * session,
+  const DriverOptions& opts, std::ostream& err, OutputFiles& outputs){
+	OutputCache cache(opts.cacheDir);
+	const SourceManager * src = session->sourceManager();
+	std::string key = OutputCache::key(src->data(), src->size(),
+	  cacheOptions(opts));
+	std::string text;
+	if (cache.lookup(key, text)){
+		std::ostream * out = outputs.open(opts.threeACFile);
+		if (out == nullptr){
+			err << "InternalError: Bad output file " << opts.threeACFile
+			  << "\n";
+			return 1;
+		}
+		*out << text << std::endl;
+		return 0;
+	}
+
+	DriverOptions uncached = opts;
+	uncached.cacheDir = nullptr;
+	session->setFunctionCache(&cache);
+	int status = runSession(session, uncached, err, outputs);
+	//A run that failed may have done so by throwing out of a
+	// phase, so don't go back to the session unless it passed
+	if (status == 0 && session->context()->diags.all().empty()){
+		if (IRProgram * prog = session->ir()){
+			cache.store(key, prog->toString());
+			if (const IncrementalPlan * plan = session->incrementalPlan()){
+				plan->storeFresh(prog, &cache);
+			}
+		}
+	}
+	return status;
+}
+
+static bool streamable(const DriverOptions& opts){
+	return opts.stream && opts.tokensFile == nullptr
+	  && opts.tokenFileOut == nullptr && opts.tokenFileIn == nullptr
+	  && opts.unparseFile == nullptr && opts.nameFile == nullptr
+	  && (opts.checkTypes || opts.threeACFile != nullptr);
+}
+
+//The outputs and messages are the same as below, but served
+// from a StreamCompiler instead of the session's phases
+static int runStreaming(CompilationSession * session,
+  const DriverOptions& opts, std::ostream& err, OutputFiles& outputs){
+	try {
+		StreamCompiler stream(session->context(),
+		  !opts.checkTypes && opts.threeACFile != nullptr);
+		stream.run();
+		if (opts.checkParse && !stream.parsed()){
+			err << "Parse failed";
+		}
+		if (!stream.passed()){
+			err << "Type Analysis Failed\n";
+			return 1;
+		}
+		if (opts.checkTypes){ return 0; }
+		if (!stream.lowerError().empty()){
+			err << stream.lowerError() << "\n";
+			return 1;
+		}
+		stream.write3AC(openOrDie(outputs, opts.threeACFile));
+	} catch (ToDoError * e){
+		err << "ToDoError: " << e->msg() << "\n";
+		return 1;
+	} catch (InternalError * e){
+		err << "InternalError: " << e->msg() << "\n";
+		return 1;
+	}
+	return 0;
+}
+
+int runSession(CompilationSession * session,
+  const DriverOptions& opts, std::ostream& err, OutputFiles& outputs){
+	session->context()->lexer = opts.lexer;
+	if (opts.tokenFileIn != nullptr){
+		TokenFile * file = TokenFile::open(opts.tokenFileIn);
+		if (file == nullptr){
+			err << "Bad token file " << opts.tokenFileIn << "\n";
+			return 1;
+		}
+		if (!file->matches(*session->sourceManager())){
+			err << "Token file " << opts.tokenFileIn
+			  << " was not written for this input\n";
+			delete file;
+			return 1;
+		}
+		session->setTokenFile(file);
+	}
+	if (streamable(opts)){
+		return runStreaming(session, opts, err, outputs);
+	}
+	session->setThreads(opts.threads);
+	if (cacheable(opts)){
+		return runCached(session, opts, err, outputs);
+	}
+
+	//Every output below is served from the same session, so
+	// the input is lexed, parsed and analyzed at most once no
+	// matter how many outputs were requested
+	try {
+		if (opts.tokensFile != nullptr){
+			outputTokens(session, opts.tokensFile, outputs);
+		}
+		if (opts.tokenFileOut != nullptr){
+			outputTokenFile(session, opts.tokenFileOut, outputs);
+		}
+		if (opts.checkParse){
+			if (!session->ast()){
+				err << "Parse failed";
+			}
+		}
+		if (opts.unparseFile != nullptr){
+			doUnparsing(session, opts.unparseFile, err, outputs);
+		}
+		if (opts.nameFile){
+			NameAnalysis * na = session->nameAnalysis();
+			if (na != nullptr){
+				outputAST(session->ast(), opts.nameFile, outputs);
+				return 0;
+			}
+			err << "Name Analysis Failed\n";
+			return 1;
+		}
+		if (opts.checkTypes){
+			if (session->typeAnalysis() != nullptr){
+				return 0;
+			}
+			err << "Type Analysis Failed\n";
+			return 1;
+		}
+		if (opts.threeACFile){
+			if (auto prog = session->ir()){
+				write3AC(prog, opts.threeACFile, outputs);
+			}
+			if (session->typeAnalysis() != nullptr){
+				return 0;
+			}
+			err << "Type Analysis Failed\n";
+			return 1;
+		}
+	} catch (ToDoError * e){
+		err << "ToDoError: " << e->msg() << "\n";
+		return 1;
+	} catch (InternalError * e){
+		err << "InternalError: " << e->msg() << "\n";
+		return 1;
+	}
+
+	return 0;
+}
+
+//The input path with its extension (if any) cut off
+static std::string pathStem(const std::string& path){
+	size_t dot = path.rfind('.');
+	size_t slash = path.rfind('/');
+	if (dot == std::string::npos
+	  || (slash != std::string::npos && dot < slash)){
+		return path;
+	}
+	return path.substr(0, dot);
+}
+
+//Compile one input of a batch. Everything the compilation
+// reports, the driver's own messages included, goes to the
+// input's .err file.
+static bool compileOne(const std::string& path,
+  const BatchOptions& opts){
+	std::string stem = pathStem(path);
+	std::ofstream errOut(stem + ".err");
+
+	CompilationSession session(path.c_str(), errOut, errOut);
+	if (!session.good()){
+		errOut << "Bad path " << path << std::endl;
+		return false;
+	}
+
+	std::string tokensFile = stem + ".tokens";
+	std::string unparseFile = stem + ".unparse";
+	std::string nameFile = stem + ".names";
+	std::string threeACFile = stem + ".3ac";
+	DriverOptions fileOpts;
+	if (opts.tokens){ fileOpts.tokensFile = tokensFile.c_str(); }
+	fileOpts.checkParse = opts.checkParse;
+	if (opts.unparse){ fileOpts.unparseFile = unparseFile.c_str(); }
+	if (opts.names){ fileOpts.nameFile = nameFile.c_str(); }
+	fileOpts.checkTypes = opts.checkTypes;
+	if (opts.threeAC){ fileOpts.threeACFile = threeACFile.c_str(); }
+	fileOpts.cacheDir = opts.cacheDir;
+	fileOpts.stream = opts.stream;
+	fileOpts.lexer = opts.lexer;
+	return runSession(&session, fileOpts, errOut) == 0;
+}
+
+int runBatch(const std::vector<std::string>& inputs,
+  const BatchOptions& opts){
+	std::vector<char> succeeded(inputs.size(), 0);
+	parallelFor(inputs.size(), opts.threads, [&](size_t i){
+		succeeded[i] = compileOne(inputs[i], opts) ? 1 : 0;
+	});
+
+	int status = 0;
+	for (size_t i = 0; i < inputs.size(); i++){
+		if (!succeeded[i]){
+			std::cerr << inputs[i] << ": failed (see "
+			  << pathStem(inputs[i]) << ".err)\n";
+			status = 1;
+		}
+	}
+	return status;
+}
+
+}
@@ -0,0 +1,44 @@
+#include "emitter.hpp"
+
+namespace holeyc{
+
+const size_t Emitter::FLUSH_AT;
+
+Emitter::Emitter(std::ostream& outIn)
+: out(&outIn), buf(&ownBuf){
+	//A little headroom, since the buffer is only flushed once
+	// it has passed FLUSH_AT
+	ownBuf.reserve(FLUSH_AT + 4096);
+}
+
+Emitter::Emitter(std::string& strIn)
+: out(nullptr), buf(&strIn){
+}
+
+void Emitter::putNum(unsigned long long num){
+	char digits[20];
+	size_t start = sizeof(digits);
+	do {
+		digits[--start] = static_cast<char>('0' + num % 10);
+		num /= 10;
+	} while (num != 0);
+	put(digits + start, sizeof(digits) - start);
+}
+
+void Emitter::putInt(long long num){
+	if (num < 0){
+		put("-", 1);
+		//Negate as unsigned, which is defined for the minimum too
+		putNum(0ULL - static_cast<unsigned long long>(num));
+		return;
+	}
+	putNum(static_cast<unsigned long long>(num));
+}
+
+void Emitter::flush(){
+	if (out == nullptr || buf->empty()){ return; }
+	out->write(buf->data(), static_cast<std::streamsize>(buf->size()));
+	buf->clear();
+}
+
+}
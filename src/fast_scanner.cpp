@@ -0,0 +1,444 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "fast_scanner.hpp"
+
+namespace holeyc{
+
+using TokenKind = holeyc::Parser::token;
+using Lexeme = holeyc::Parser::semantic_type;
+
+//The runs below are classified a chunk of bytes at a time: each
+// byte of the chunk is compared at once, and the comparisons
+// collapse into a bitmask with one bit per byte. Only whole
+// chunks are loaded, so the tail of the input is done a byte at
+// a time. SSE2 compares are signed, so bytes past ASCII never
+// fall in the ranges tested for.
+#if defined(__AVX2__)
+#define HOLEYC_CHUNKED 1
+typedef __m256i Chunk;
+static const size_t CHUNK_SIZE = 32;
+static const uint32_t ALL_BYTES = 0xFFFFFFFFu;
+static inline Chunk chunkAt(const char * p){
+	return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+static inline Chunk bytesEqual(Chunk c, char b){
+	return _mm256_cmpeq_epi8(c, _mm256_set1_epi8(b));
+}
+static inline Chunk bytesIn(Chunk c, char lo, char hi){
+	Chunk loBound = _mm256_set1_epi8(static_cast<char>(lo - 1));
+	Chunk hiBound = _mm256_set1_epi8(static_cast<char>(hi + 1));
+	return _mm256_and_si256(_mm256_cmpgt_epi8(c, loBound),
+	  _mm256_cmpgt_epi8(hiBound, c));
+}
+static inline Chunk either(Chunk a, Chunk b){ return _mm256_or_si256(a, b); }
+static inline Chunk lowered(Chunk c){
+	return _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+}
+static inline uint32_t byteMask(Chunk c){
+	return static_cast<uint32_t>(_mm256_movemask_epi8(c));
+}
+#elif defined(__SSE2__)
+#define HOLEYC_CHUNKED 1
+typedef __m128i Chunk;
+static const size_t CHUNK_SIZE = 16;
+static const uint32_t ALL_BYTES = 0xFFFFu;
+static inline Chunk chunkAt(const char * p){
+	return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+static inline Chunk bytesEqual(Chunk c, char b){
+	return _mm_cmpeq_epi8(c, _mm_set1_epi8(b));
+}
+static inline Chunk bytesIn(Chunk c, char lo, char hi){
+	Chunk loBound = _mm_set1_epi8(static_cast<char>(lo - 1));
+	Chunk hiBound = _mm_set1_epi8(static_cast<char>(hi + 1));
+	return _mm_and_si128(_mm_cmpgt_epi8(c, loBound),
+	  _mm_cmpgt_epi8(hiBound, c));
+}
+static inline Chunk either(Chunk a, Chunk b){ return _mm_or_si128(a, b); }
+static inline Chunk lowered(Chunk c){
+	return _mm_or_si128(c, _mm_set1_epi8(0x20));
+}
+static inline uint32_t byteMask(Chunk c){
+	return static_cast<uint32_t>(_mm_movemask_epi8(c));
+}
+#endif
+
+static inline bool isBlank(char c){ return c == ' ' || c == '\t'; }
+static inline bool isDigit(char c){ return c >= '0' && c <= '9'; }
+static inline bool isWordChar(char c){
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+	  || isDigit(c) || c == '_';
+}
+//Can follow a backslash in a string literal
+static inline bool isEscapee(char c){
+	return c == 'n' || c == 't' || c == '\'' || c == '"' || c == '\\';
+}
+//Can be in a string literal without ending it or escaping
+static inline bool isStrPlain(char c){
+	return c != '\n' && c != '"' && c != '\\';
+}
+
+//Each run function returns how many bytes from p on (but
+// before end) are in its run
+
+//[ \t]*
+static size_t blankRun(const char * p, const char * end){
+	const char * start = p;
+#ifdef HOLEYC_CHUNKED
+	for (; end - p >= static_cast<ptrdiff_t>(CHUNK_SIZE); p += CHUNK_SIZE){
+		Chunk c = chunkAt(p);
+		uint32_t in = byteMask(either(bytesEqual(c, ' '),
+		  bytesEqual(c, '\t')));
+		if (in != ALL_BYTES){
+			return static_cast<size_t>(p - start)
+			  + static_cast<size_t>(__builtin_ctz(~in));
+		}
+	}
+#endif
+	while (p < end && isBlank(*p)){ p++; }
+	return static_cast<size_t>(p - start);
+}
+
+//[a-zA-Z0-9_]*
+static size_t wordRun(const char * p, const char * end){
+	const char * start = p;
+#ifdef HOLEYC_CHUNKED
+	for (; end - p >= static_cast<ptrdiff_t>(CHUNK_SIZE); p += CHUNK_SIZE){
+		Chunk c = chunkAt(p);
+		Chunk letters = bytesIn(lowered(c), 'a', 'z');
+		Chunk rest = either(bytesIn(c, '0', '9'), bytesEqual(c, '_'));
+		uint32_t in = byteMask(either(letters, rest));
+		if (in != ALL_BYTES){
+			return static_cast<size_t>(p - start)
+			  + static_cast<size_t>(__builtin_ctz(~in));
+		}
+	}
+#endif
+	while (p < end && isWordChar(*p)){ p++; }
+	return static_cast<size_t>(p - start);
+}
+
+//[^\n]*
+static size_t lineRun(const char * p, const char * end){
+	const char * start = p;
+#ifdef HOLEYC_CHUNKED
+	for (; end - p >= static_cast<ptrdiff_t>(CHUNK_SIZE); p += CHUNK_SIZE){
+		uint32_t out = byteMask(bytesEqual(chunkAt(p), '\n'));
+		if (out != 0){
+			return static_cast<size_t>(p - start)
+			  + static_cast<size_t>(__builtin_ctz(out));
+		}
+	}
+#endif
+	while (p < end && *p != '\n'){ p++; }
+	return static_cast<size_t>(p - start);
+}
+
+//[^\n"\\]*
+static size_t strRun(const char * p, const char * end){
+	const char * start = p;
+#ifdef HOLEYC_CHUNKED
+	for (; end - p >= static_cast<ptrdiff_t>(CHUNK_SIZE); p += CHUNK_SIZE){
+		Chunk c = chunkAt(p);
+		uint32_t out = byteMask(either(bytesEqual(c, '\n'),
+		  either(bytesEqual(c, '"'), bytesEqual(c, '\\'))));
+		if (out != 0){
+			return static_cast<size_t>(p - start)
+			  + static_cast<size_t>(__builtin_ctz(out));
+		}
+	}
+#endif
+	while (p < end && isStrPlain(*p)){ p++; }
+	return static_cast<size_t>(p - start);
+}
+
+struct Keyword{
+	const char * text;
+	size_t len;
+	int kind;
+};
+
+static const Keyword KEYWORDS[] = {
+	{"int", 3, TokenKind::INT},
+	{"intptr", 6, TokenKind::INTPTR},
+	{"bool", 4, TokenKind::BOOL},
+	{"boolptr", 7, TokenKind::BOOLPTR},
+	{"char", 4, TokenKind::CHAR},
+	{"charptr", 7, TokenKind::CHARPTR},
+	{"void", 4, TokenKind::VOID},
+	{"if", 2, TokenKind::IF},
+	{"else", 4, TokenKind::ELSE},
+	{"while", 5, TokenKind::WHILE},
+	{"return", 6, TokenKind::RETURN},
+	{"false", 5, TokenKind::FALSE},
+	{"true", 4, TokenKind::TRUE},
+	{"FROMCONSOLE", 11, TokenKind::FROMCONSOLE},
+	{"TOCONSOLE", 9, TokenKind::TOCONSOLE},
+	{"NULLPTR", 7, TokenKind::NULLPTR},
+};
+
+int FastScanner::makeBareToken(Lexeme * lval, int kind, size_t len){
+	nextOffset += static_cast<SrcOffset>(len);
+	lval->transToken = tokenArena->make<Token>(tokenStart, kind);
+	return kind;
+}
+
+//A keyword or an identifier: flex takes the keyword, since
+// its rule comes first and the match is as long
+int FastScanner::lexWord(Lexeme * lval){
+	const char * p = src->data() + tokenStart;
+	const char * end = src->data() + inputEnd;
+	size_t len = 1 + wordRun(p + 1, end);
+	for (const Keyword& kw : KEYWORDS){
+		if (kw.len == len && memcmp(kw.text, p, len) == 0){
+			return makeBareToken(lval, kw.kind, len);
+		}
+	}
+	nextOffset += static_cast<SrcOffset>(len);
+	lval->transToken = tokenArena->make<IDToken>(tokenStart,
+	  names->intern(p, len));
+	return TokenKind::ID;
+}
+
+int FastScanner::lexInt(Lexeme * lval){
+	const char * p = src->data() + tokenStart;
+	const char * end = src->data() + inputEnd;
+	const char * at = p;
+	while (at < end && isDigit(*at)){ at++; }
+	size_t len = static_cast<size_t>(at - p);
+	nextOffset += static_cast<SrcOffset>(len);
+	int intVal = intValue(p, len);
+	lval->transToken = tokenArena->make<IntLitToken>(tokenStart, intVal);
+	return TokenKind::INTLITERAL;
+}
+
+//Of the four string rules in holeyc.l, which matches longest
+// depends on where the first bad escape (if any) falls relative
+// to the quotes after it, so the body is followed as far as
+// each rule could go
+int FastScanner::lexString(Lexeme * lval){
+	const char * p = src->data() + tokenStart;
+	const char * end = src->data() + inputEnd;
+	size_t avail = static_cast<size_t>(end - p);
+
+	//The longest body of plain characters and good escapes
+	size_t at = 1;
+	while (true){
+		at += strRun(p + at, end);
+		if (at == avail || p[at] == '\n'){
+			nextOffset += static_cast<SrcOffset>(at);
+			errStrUnterm();
+			return NO_TOKEN;
+		}
+		if (p[at] == '"'){
+			//Flex hands the action the match as a C string, so the
+			// text stops at a NUL byte
+			size_t len = at + 1;
+			const void * nul = memchr(p, '\0', len);
+			if (nul != nullptr){
+				len = static_cast<size_t>(static_cast<const char *>(nul) - p);
+			}
+			nextOffset += static_cast<SrcOffset>(at + 1);
+			lval->transToken = tokenArena->make<StrToken>(tokenStart,
+			  TextView(p, len));
+			return TokenKind::STRLITERAL;
+		}
+		if (at + 1 < avail && isEscapee(p[at + 1])){
+			at += 2;
+			continue;
+		}
+		break;
+	}
+	//A backslash at the end of the line ends the unterminated
+	// match that includes it
+	if (at + 1 == avail || p[at + 1] == '\n'){
+		nextOffset += static_cast<SrcOffset>(at + 1);
+		errStrEscAndUnterm();
+		return NO_TOKEN;
+	}
+
+	//A bad escape. The unterminated match runs on through good
+	// escapes until the line ends, a quote, or (taking its
+	// backslash) another bad escape
+	size_t untermEnd = at + 2;
+	while (true){
+		untermEnd += strRun(p + untermEnd, end);
+		if (untermEnd == avail || p[untermEnd] != '\\'){ break; }
+		if (untermEnd + 1 < avail && isEscapee(p[untermEnd + 1])){
+			untermEnd += 2;
+			continue;
+		}
+		untermEnd++;
+		break;
+	}
+	//The terminated match runs to the next quote on the line,
+	// escaped or not
+	size_t quote = at + 2;
+	while (quote < avail && p[quote] != '"' && p[quote] != '\n'){
+		quote++;
+	}
+	if (quote < avail && p[quote] == '"' && quote + 1 >= untermEnd){
+		nextOffset += static_cast<SrcOffset>(quote + 1);
+		errStrEsc();
+	} else {
+		nextOffset += static_cast<SrcOffset>(untermEnd);
+		errStrEscAndUnterm();
+	}
+	return NO_TOKEN;
+}
+
+int FastScanner::lexCharLit(Lexeme * lval){
+	const char * p = src->data() + tokenStart;
+	size_t avail = inputEnd - tokenStart;
+	size_t len = 2;
+	char val;
+	if (avail == 1){
+		nextOffset += 1;
+		errIllegal("'");
+		return NO_TOKEN;
+	}
+	if (p[1] == '\\'){
+		char esc = avail > 2 ? p[2] : '\n';
+		switch (esc){
+		case 't': val = '\t'; break;
+		case 'n': val = '\n'; break;
+		case '\\': val = '\\'; break;
+		case '\t': val = '\t'; break;
+		case ' ': val = ' '; break;
+		case '\n':
+		case '\r':
+			nextOffset += 2;
+			errChrEscEmpty();
+			return NO_TOKEN;
+		default:
+			nextOffset += 3;
+			errChrEsc();
+			return NO_TOKEN;
+		}
+		len = 3;
+	} else if (p[1] == '\n'){
+		nextOffset += 2;
+		errChrEmpty();
+		return NO_TOKEN;
+	} else if (p[1] == '\r' && avail > 2 && p[2] == '\n'){
+		nextOffset += 3;
+		errChrEmpty();
+		return NO_TOKEN;
+	} else {
+		val = p[1];
+	}
+	nextOffset += static_cast<SrcOffset>(len);
+	lval->transToken = tokenArena->make<CharLitToken>(tokenStart, val);
+	return TokenKind::CHARLIT;
+}
+
+int FastScanner::yylex(Lexeme * const lval){
+	const char * input = src->data();
+	const char * end = input + inputEnd;
+	while (nextOffset < inputEnd){
+		//Every match moves tokenStart, as flex's does, even the
+		// ones that make no token
+		tokenStart = nextOffset;
+		const char * p = input + nextOffset;
+		char next = p + 1 < end ? p[1] : '\0';
+		int kind = NO_TOKEN;
+		switch (*p){
+		case ' ':
+		case '\t':
+			nextOffset += static_cast<SrcOffset>(blankRun(p, end));
+			continue;
+		case '\n':
+			nextOffset += 1;
+			continue;
+		case '\r':
+			if (p + 1 < end && next == '\n'){
+				nextOffset += 2;
+				continue;
+			}
+			nextOffset += 1;
+			errIllegal("\r");
+			continue;
+		case '#':
+			nextOffset += static_cast<SrcOffset>(1 + lineRun(p + 1, end));
+			continue;
+		case '"': kind = lexString(lval); break;
+		case '\'': kind = lexCharLit(lval); break;
+		case '@': return makeBareToken(lval, TokenKind::AT, 1);
+		case '^': return makeBareToken(lval, TokenKind::CARAT, 1);
+		case '[': return makeBareToken(lval, TokenKind::LBRACE, 1);
+		case ']': return makeBareToken(lval, TokenKind::RBRACE, 1);
+		case '{': return makeBareToken(lval, TokenKind::LCURLY, 1);
+		case '}': return makeBareToken(lval, TokenKind::RCURLY, 1);
+		case '(': return makeBareToken(lval, TokenKind::LPAREN, 1);
+		case ')': return makeBareToken(lval, TokenKind::RPAREN, 1);
+		case ';': return makeBareToken(lval, TokenKind::SEMICOLON, 1);
+		case ',': return makeBareToken(lval, TokenKind::COMMA, 1);
+		case '*': return makeBareToken(lval, TokenKind::STAR, 1);
+		case '/': return makeBareToken(lval, TokenKind::SLASH, 1);
+		case '+':
+			if (next == '+'){
+				return makeBareToken(lval, TokenKind::CROSSCROSS, 2);
+			}
+			return makeBareToken(lval, TokenKind::CROSS, 1);
+		case '-':
+			if (next == '-'){
+				return makeBareToken(lval, TokenKind::DASHDASH, 2);
+			}
+			return makeBareToken(lval, TokenKind::DASH, 1);
+		case '!':
+			if (next == '='){
+				return makeBareToken(lval, TokenKind::NOTEQUALS, 2);
+			}
+			return makeBareToken(lval, TokenKind::NOT, 1);
+		case '=':
+			if (next == '='){
+				return makeBareToken(lval, TokenKind::EQUALS, 2);
+			}
+			return makeBareToken(lval, TokenKind::ASSIGN, 1);
+		case '<':
+			if (next == '='){
+				return makeBareToken(lval, TokenKind::LESSEQ, 2);
+			}
+			return makeBareToken(lval, TokenKind::LESS, 1);
+		case '>':
+			if (next == '='){
+				return makeBareToken(lval, TokenKind::GREATEREQ, 2);
+			}
+			return makeBareToken(lval, TokenKind::GREATER, 1);
+		case '&':
+			if (next == '&'){
+				return makeBareToken(lval, TokenKind::AND, 2);
+			}
+			nextOffset += 1;
+			errIllegal("&");
+			continue;
+		case '|':
+			if (next == '|'){
+				return makeBareToken(lval, TokenKind::OR, 2);
+			}
+			nextOffset += 1;
+			errIllegal("|");
+			continue;
+		default:
+			if (isDigit(*p)){ return lexInt(lval); }
+			if (isWordChar(*p)){ return lexWord(lval); }
+			//Flex reports the match as a C string, so a NUL
+			// byte comes out as nothing at all
+			nextOffset += 1;
+			errIllegal(*p == '\0' ? std::string() : std::string(1, *p));
+			continue;
+		}
+		if (kind != NO_TOKEN){ return kind; }
+	}
+	return TokenKind::END;
+}
+
+}
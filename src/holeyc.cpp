@@ -0,0 +1,81 @@
+#include "holeyc.hpp"
+
+namespace holeyc{
+
+Compilation::Compilation(SourceBuffer * source, const char * name)
+: mySession(source, name, myText, myText){
+}
+
+Compilation::~Compilation(){
+}
+
+Compilation * Compilation::fromString(const std::string& text,
+  const char * name){
+	return new Compilation(SourceBuffer::copy(text.data(), text.size()),
+	  name);
+}
+
+Compilation * Compilation::fromBuffer(const char * data, size_t size,
+  const char * name){
+	return new Compilation(SourceBuffer::borrow(data, size), name);
+}
+
+Compilation * Compilation::fromFile(const char * path){
+	return new Compilation(SourceBuffer::open(path), path);
+}
+
+//Run a phase of the session, turning an internal error into a
+// diagnostic. A phase that threw may have been left half done,
+// so nothing is run again after one has.
+template <typename Result, typename Phase>
+Result * Compilation::guard(Phase phase){
+	if (crashed || !good()){ return nullptr; }
+	Diagnostics& diags = mySession.context()->diags;
+	try {
+		return phase();
+	} catch (ToDoError * e){
+		myText << "ToDoError: " << e->msg() << "\n";
+		diags.internal(e->msg());
+		delete e;
+	} catch (InternalError * e){
+		myText << "InternalError: " << e->msg() << "\n";
+		diags.internal(e->msg());
+		delete e;
+	}
+	crashed = true;
+	return nullptr;
+}
+
+ProgramNode * Compilation::ast(){
+	return guard<ProgramNode>([this](){ return mySession.ast(); });
+}
+
+NameAnalysis * Compilation::nameAnalysis(){
+	return guard<NameAnalysis>([this](){
+		return mySession.nameAnalysis(); 
+	});
+}
+
+TypeAnalysis * Compilation::typeAnalysis(){
+	return guard<TypeAnalysis>([this](){
+		return mySession.typeAnalysis();
+	});
+}
+
+IRProgram * Compilation::ir(){
+	return guard<IRProgram>([this](){ return mySession.ir(); });
+}
+
+bool Compilation::threeAC(std::string& out){
+	IRProgram * prog = ir();
+	if (prog == nullptr){ return false; }
+	std::string * text = guard<std::string>([prog](){
+		return new std::string(prog->toString());
+	});
+	if (text == nullptr){ return false; }
+	out.swap(*text);
+	delete text;
+	return true;
+}
+
+}
@@ -13,7 +13,9 @@
 	#include "tokens.hpp"
 	#include "ast.hpp"
 	namespace holeyc {
-		class Scanner;
+		class TokenSource;
+		class ASTBuilder;
+		class Diagnostics;
 	}
 
 //The following definition is required when 
@@ -29,8 +31,10 @@
 //End "requires" code
 }
 
-%parse-param { holeyc::Scanner &scanner }
+%parse-param { holeyc::TokenSource &scanner }
+%parse-param { holeyc::ASTBuilder &builder }
 %parse-param { holeyc::ProgramNode** root }
+%parse-param { holeyc::Diagnostics &diags }
 
 %code{
    // C std code for utility functions
@@ -39,8 +43,10 @@
    #include <fstream>
 
    // Our code for interoperation between scanner/parser
-   #include "scanner.hpp"
+   #include "token_stream.hpp"
    #include "ast.hpp"
+   #include "ast_builder.hpp"
+   #include "errors.hpp"
    #include "tokens.hpp"
 
   //Request tokens from our scanner member, not 
@@ -50,29 +56,29 @@
 }
 
 %union {
-   bool                                  transBool;
-   holeyc::Token*                         transToken;
-   holeyc::IDToken*                       transIDToken;
-   holeyc::IntLitToken*                   transIntToken;
-   holeyc::StrToken*                      transStrToken;
-   holeyc::CharLitToken*                  transCharToken;
-   holeyc::ProgramNode*                   transProgram;
-   std::list<holeyc::DeclNode *> *        transDeclList;
-   holeyc::DeclNode *                     transDecl;
-   holeyc::VarDeclNode *                  transVarDecl;
-   std::list<holeyc::FormalDeclNode *> *  transFormals;
-   holeyc::FormalDeclNode *               transFormal;
-   holeyc::TypeNode *                     transType;
-   holeyc::LValNode *                     transLVal;
-   holeyc::IDNode *                       transID;
-   holeyc::FnDeclNode *                   transFn;
-   std::list<holeyc::VarDeclNode *> *     transVarDecls;
-   std::list<holeyc::StmtNode *> *        transStmts;
-   holeyc::StmtNode *                     transStmt;
-   holeyc::ExpNode *                      transExp;
-   holeyc::AssignExpNode *                transAssignExp;
-   holeyc::CallExpNode *                  transCallExp;
-   std::list<holeyc::ExpNode *> *         transActuals;
+   bool                                         transBool;
+   holeyc::Token*                               transToken;
+   holeyc::IDToken*                             transIDToken;
+   holeyc::IntLitToken*                         transIntToken;
+   holeyc::StrToken*                            transStrToken;
+   holeyc::CharLitToken*                        transCharToken;
+   holeyc::ProgramNode*                         transProgram;
+   holeyc::NodeList<holeyc::DeclNode *> *       transDeclList;
+   holeyc::DeclNode *                           transDecl;
+   holeyc::VarDeclNode *                        transVarDecl;
+   holeyc::NodeList<holeyc::FormalDeclNode *> * transFormals;
+   holeyc::FormalDeclNode *                     transFormal;
+   holeyc::TypeNode *                           transType;
+   holeyc::LValNode *                           transLVal;
+   holeyc::IDNode *                             transID;
+   holeyc::FnDeclNode *                         transFn;
+   holeyc::NodeList<holeyc::VarDeclNode *> *    transVarDecls;
+   holeyc::NodeList<holeyc::StmtNode *> *       transStmts;
+   holeyc::StmtNode *                           transStmt;
+   holeyc::ExpNode *                            transExp;
+   holeyc::AssignExpNode *                      transAssignExp;
+   holeyc::CallExpNode *                        transCallExp;
+   holeyc::NodeList<holeyc::ExpNode *> *        transActuals;
 }
 
 %define parse.assert
@@ -161,7 +167,8 @@
 
 program 	: globals
 		  {
-		  $$ = new ProgramNode($1);
+		  $$ = builder.make<ProgramNode>($1);
+		  $$->setNodeCount(builder.nodeCount());
 		  *root = $$;
 		  }
 
@@ -169,11 +176,13 @@ globals 	: globals decl
 	  	  { 
 	  	  $$ = $1; 
 	  	  DeclNode * declNode = $2;
-		  $$->push_back(declNode);
+		  if (!builder.topLevel(declNode)){
+		  	$$->push_back(declNode);
+		  }
 	  	  }
 		| /* epsilon */
 		  {
-		  $$ = new std::list<DeclNode * >();
+		  $$ = builder.makeGlobals();
 		  }
 
 decl 		: varDecl SEMICOLON
@@ -183,49 +192,47 @@ decl 		: varDecl SEMICOLON
 
 varDecl 	: type id
 		  {
-		  size_t line = $1->line();
-		  size_t col = $1->col();
-		  $$ = new VarDeclNode(line, col, $1, $2);
+		  $$ = builder.make<VarDeclNode>($1->offset(), $1, $2);
 		  }
 
 type 		: INT
 	  	  { 
-		  $$ = new IntTypeNode($1->line(), $1->col(), false);
+		  $$ = builder.make<IntTypeNode>($1->offset(), false);
 		  }
 		| INTPTR
 	  	  { 
-		  $$ = new IntTypeNode($1->line(), $1->col(), true);
+		  $$ = builder.make<IntTypeNode>($1->offset(), true);
 		  }
 		| BOOL
 		  {
-		  $$ = new BoolTypeNode($1->line(), $1->col(), false);
+		  $$ = builder.make<BoolTypeNode>($1->offset(), false);
 		  }
 		| BOOLPTR
 		  {
-		  $$ = new BoolTypeNode($1->line(), $1->col(), true);
+		  $$ = builder.make<BoolTypeNode>($1->offset(), true);
 		  }
 		| CHAR
 		  {
-		  $$ = new CharTypeNode($1->line(), $1->col(), false);
+		  $$ = builder.make<CharTypeNode>($1->offset(), false);
 		  }
 		| CHARPTR
 		  {
-		  $$ = new CharTypeNode($1->line(), $1->col(), true);
+		  $$ = builder.make<CharTypeNode>($1->offset(), true);
 		  }
 		| VOID
 		  {
-		  $$ = new VoidTypeNode($1->line(), $1->col());
+		  $$ = builder.make<VoidTypeNode>($1->offset());
 		  }
 
 fnDecl 		: type id formals fnBody
 		  {
-		  $$ = new FnDeclNode($1->line(), $1->col(), 
+		  $$ = builder.make<FnDeclNode>($1->offset(), 
 		    $1, $2, $3, $4);
 		  }
 
 formals 	: LPAREN RPAREN
 		  {
-		  $$ = new std::list<FormalDeclNode *>();
+		  $$ = builder.makeList<FormalDeclNode *>();
 		  }
 		| LPAREN formalsList RPAREN
 		  {
@@ -235,7 +242,7 @@ formals 	: LPAREN RPAREN
 
 formalsList	: formalDecl
 		  {
-		  $$ = new std::list<FormalDeclNode *>();
+		  $$ = builder.makeList<FormalDeclNode *>();
 		  $$->push_back($1);
 		  }
 		| formalDecl COMMA formalsList 
@@ -246,7 +253,7 @@ formalsList	: formalDecl
 
 formalDecl 	: type id
 		  {
-		  $$ = new FormalDeclNode($1->line(), $1->col(), 
+		  $$ = builder.make<FormalDeclNode>($1->offset(), 
 		    $1, $2);
 		  }
 
@@ -257,7 +264,7 @@ fnBody		: LCURLY stmtList RCURLY
 
 stmtList 	: /* epsilon */
 	   	  {
-		  $$ = new std::list<StmtNode *>();
+		  $$ = builder.makeList<StmtNode *>();
 		  //$$->push_back($1);
 	   	  }
 		| stmtList stmt
@@ -272,129 +279,129 @@ stmt		: varDecl SEMICOLON
 		  }
 		| assignExp SEMICOLON
 		  {
-		  $$ = new AssignStmtNode($1->line(), $1->col(), $1); 
+		  $$ = builder.make<AssignStmtNode>($1->offset(), $1); 
 		  }
 		| lval DASHDASH SEMICOLON
 		  {
-		  $$ = new PostDecStmtNode($2->line(), $2->col(), $1);
+		  $$ = builder.make<PostDecStmtNode>($2->offset(), $1);
 		  }
 		| lval CROSSCROSS SEMICOLON
 		  {
-		  $$ = new PostIncStmtNode($2->line(), $2->col(), $1);
+		  $$ = builder.make<PostIncStmtNode>($2->offset(), $1);
 		  }
 		| FROMCONSOLE lval SEMICOLON
 		  {
-		  $$ = new FromConsoleStmtNode($1->line(), $1->col(), $2);
+		  $$ = builder.make<FromConsoleStmtNode>($1->offset(), $2);
 		  }
 		| TOCONSOLE exp SEMICOLON
 		  {
-		  $$ = new ToConsoleStmtNode($1->line(), $1->col(), $2);
+		  $$ = builder.make<ToConsoleStmtNode>($1->offset(), $2);
 		  }
 		| IF LPAREN exp RPAREN LCURLY stmtList RCURLY
 		  {
-		  $$ = new IfStmtNode($1->line(), $1->col(), $3, $6);
+		  $$ = builder.make<IfStmtNode>($1->offset(), $3, $6);
 		  }
 		| IF LPAREN exp RPAREN LCURLY stmtList RCURLY ELSE LCURLY stmtList RCURLY
 		  {
-		  $$ = new IfElseStmtNode($1->line(), $1->col(), $3, 
+		  $$ = builder.make<IfElseStmtNode>($1->offset(), $3, 
 		    $6, $10);
 		  }
 		| WHILE LPAREN exp RPAREN LCURLY stmtList RCURLY
 		  {
-		  $$ = new WhileStmtNode($1->line(), $1->col(), $3, $6);
+		  $$ = builder.make<WhileStmtNode>($1->offset(), $3, $6);
 		  }
 		| RETURN exp SEMICOLON
 		  {
-		  $$ = new ReturnStmtNode($1->line(), $1->col(), $2);
+		  $$ = builder.make<ReturnStmtNode>($1->offset(), $2);
 		  }
 		| RETURN SEMICOLON
 		  {
-		  $$ = new ReturnStmtNode($1->line(), $1->col(), nullptr);
+		  $$ = builder.make<ReturnStmtNode>($1->offset(), nullptr);
 		  }
 		| callExp SEMICOLON
-		  { $$ = new CallStmtNode($1->line(), $1->col(), $1); }
+		  { $$ = builder.make<CallStmtNode>($1->offset(), $1); }
 
 exp		: assignExp 
 		  { $$ = $1; } 
 		| exp DASH exp
 	  	  {
-		  $$ = new MinusNode($2->line(), $2->col(), $1, $3);
+		  $$ = builder.make<MinusNode>($2->offset(), $1, $3);
 		  }
 		| exp CROSS exp
 	  	  {
-		  $$ = new PlusNode($2->line(), $2->col(), $1, $3);
+		  $$ = builder.make<PlusNode>($2->offset(), $1, $3);
 		  }
 		| exp STAR exp
 	  	  {
-		  $$ = new TimesNode($2->line(), $2->col(), $1, $3);
+		  $$ = builder.make<TimesNode>($2->offset(), $1, $3);
 		  }
 		| exp SLASH exp
 	  	  {
-		  $$ = new DivideNode($2->line(), $2->col(), $1, $3);
+		  $$ = builder.make<DivideNode>($2->offset(), $1, $3);
 		  }
 		| exp AND exp
 	  	  {
-		  $$ = new AndNode($2->line(), $2->col(), $1, $3);
+		  $$ = builder.make<AndNode>($2->offset(), $1, $3);
 		  }
 		| exp OR exp
 	  	  {
-		  $$ = new OrNode($2->line(), $2->col(), $1, $3);
+		  $$ = builder.make<OrNode>($2->offset(), $1, $3);
 		  }
 		| exp EQUALS exp
 	  	  {
-		  $$ = new EqualsNode($2->line(), $2->col(), $1, $3);
+		  $$ = builder.make<EqualsNode>($2->offset(), $1, $3);
 		  }
 		| exp NOTEQUALS exp
 	  	  {
-		  $$ = new NotEqualsNode($2->line(), $2->col(), $1, $3);
+		  $$ = builder.make<NotEqualsNode>($2->offset(), $1, $3);
 		  }
 		| exp GREATER exp
 	  	  {
-		  $$ = new GreaterNode($2->line(), $2->col(), $1, $3);
+		  $$ = builder.make<GreaterNode>($2->offset(), $1, $3);
 		  }
 		| exp GREATEREQ exp
 	  	  {
-		  $$ = new GreaterEqNode($2->line(), $2->col(), $1, $3);
+		  $$ = builder.make<GreaterEqNode>($2->offset(), $1, $3);
 		  }
 		| exp LESS exp
 	  	  {
-		  $$ = new LessNode($2->line(), $2->col(), $1, $3);
+		  $$ = builder.make<LessNode>($2->offset(), $1, $3);
 		  }
 		| exp LESSEQ exp
 	  	  {
-		  $$ = new LessEqNode($2->line(), $2->col(), $1, $3);
+		  $$ = builder.make<LessEqNode>($2->offset(), $1, $3);
 		  }
 		| NOT exp
 	  	  {
-		  $$ = new NotNode($1->line(), $1->col(), $2);
+		  $$ = builder.make<NotNode>($1->offset(), $2);
 		  }
 		| DASH term
 	  	  {
-		  $$ = new NegNode($1->line(), $1->col(), $2);
+		  $$ = builder.make<NegNode>($1->offset(), $2);
 		  }
 		| term 
 	  	  { $$ = $1; }
 
 assignExp	: lval ASSIGN exp
 		  {
-		  $$ = new AssignExpNode($2->line(), $2->col(), $1, $3);
+		  $$ = builder.make<AssignExpNode>($2->offset(), $1, $3);
 		  }
 
 callExp		: id LPAREN RPAREN
 		  {
-		  std::list<ExpNode *> * noargs =
-		    new std::list<ExpNode *>();
-		  $$ = new CallExpNode($1->line(), $1->col(), $1, noargs);
+		  NodeList<ExpNode *> * noargs =
+		    builder.makeList<ExpNode *>();
+		  $$ = builder.make<CallExpNode>($1->offset(), $1, noargs);
 		  }
 		| id LPAREN actualsList RPAREN
 		  {
-		  $$ = new CallExpNode($1->line(), $1->col(), $1, $3);
+		  $$ = builder.make<CallExpNode>($1->offset(), $1, $3);
 		  }
 
 actualsList	: exp
 		  {
-		  std::list<ExpNode *> * list =
-		    new std::list<ExpNode *>();
+		  NodeList<ExpNode *> * list =
+		    builder.makeList<ExpNode *>();
 		  list->push_back($1);
 		  $$ = list;
 		  }
@@ -412,18 +419,18 @@ term 		: lval
 		  }
 		| NULLPTR
 		  {
-		  $$ = new NullPtrNode($1->line(), $1->col());
+		  $$ = builder.make<NullPtrNode>($1->offset());
 		  }
 		| INTLITERAL 
-		  { $$ = new IntLitNode($1->line(), $1->col(), $1->num()); }
+		  { $$ = builder.make<IntLitNode>($1->offset(), $1->num()); }
 		| STRLITERAL 
-		  { $$ = new StrLitNode($1->line(), $1->col(), $1->str()); }
+		  { $$ = builder.make<StrLitNode>($1->offset(), $1->str()); }
 		| CHARLIT 
-		  { $$ = new CharLitNode($1->line(), $1->col(), $1->val()); }
+		  { $$ = builder.make<CharLitNode>($1->offset(), $1->val()); }
 		| TRUE
-		  { $$ = new TrueNode($1->line(), $1->col()); }
+		  { $$ = builder.make<TrueNode>($1->offset()); }
 		| FALSE
-		  { $$ = new FalseNode($1->line(), $1->col()); }
+		  { $$ = builder.make<FalseNode>($1->offset()); }
 		| LPAREN exp RPAREN
 		  { $$ = $2; }
 
@@ -433,25 +440,24 @@ lval		: id
 		  }
 		| id LBRACE exp RBRACE
 		  {
-		  $$ = new IndexNode($1->line(), $1->col(), $1, $3);
+		  $$ = builder.make<IndexNode>($1->offset(), $1, $3);
 		  }
 		| AT id
 		  {
-		  $$ = new DerefNode($1->line(), $1->col(), $2);
+		  $$ = builder.make<DerefNode>($1->offset(), $2);
 		  }
 		| CARAT id
 		  {
-		  $$ = new RefNode($1->line(), $1->col(), $2);
+		  $$ = builder.make<RefNode>($1->offset(), $2);
 		  }
 
 id		: ID
 		  {
-		  $$ = new IDNode($1->line(), $1->col(), $1->value()); 
+		  $$ = builder.make<IDNode>($1->offset(), $1->value()); 
 		  }
 	
 %%
 
 void holeyc::Parser::error(const std::string& msg){
-	std::cout << msg << std::endl;
-	std::cerr << "syntax error" << std::endl;
+	diags.syntax(scanner.lastOffset(), msg);
 }
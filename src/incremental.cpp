@@ -0,0 +1,158 @@
+#include <unordered_set>
+#include <vector>
+
+#include "incremental.hpp"
+
+namespace holeyc{
+
+//Procedures are kept in the same cache directory as whole
+// programs, under their own extension
+static const char * const PROC_EXT = ".proc";
+
+//A template is stored as its label and string counts, then
+// each string and the text, each prefixed with its length
+static std::string writeTemplate(const ProcTemplate& tmpl){
+	std::string res = std::to_string(tmpl.labels) + " "
+	  + std::to_string(tmpl.strings.size()) + "\n";
+	for (const std::string& str : tmpl.strings){
+		res += std::to_string(str.size()) + "\n" + str;
+	}
+	res += std::to_string(tmpl.text.size()) + "\n" + tmpl.text;
+	return res;
+}
+
+static bool readCount(const std::string& text, size_t& pos, char end,
+  size_t& out){
+	size_t stop = text.find(end, pos);
+	if (stop == std::string::npos || stop == pos){ return false; }
+	out = 0;
+	for (; pos < stop; pos++){
+		if (text[pos] < '0' || text[pos] > '9'){ return false; }
+		out = out * 10 + static_cast<size_t>(text[pos] - '0');
+	}
+	pos = stop + 1;
+	return true;
+}
+
+static bool readBytes(const std::string& text, size_t& pos,
+  std::string& out){
+	size_t len;
+	if (!readCount(text, pos, '\n', len) || len > text.size() - pos){
+		return false;
+	}
+	out = text.substr(pos, len);
+	pos += len;
+	return true;
+}
+
+//False if the entry is damaged, which makes it a miss
+static bool readTemplate(const std::string& text, ProcTemplate& tmpl){
+	size_t pos = 0;
+	size_t strCount;
+	if (!readCount(text, pos, ' ', tmpl.labels)
+	  || !readCount(text, pos, '\n', strCount)){
+		return false;
+	}
+	for (size_t i = 0; i < strCount; i++){
+		tmpl.strings.emplace_back();
+		if (!readBytes(text, pos, tmpl.strings.back())){ return false; }
+	}
+	return readBytes(text, pos, tmpl.text) && pos == text.size();
+}
+
+IncrementalPlan::IncrementalPlan(ProgramNode * ast,
+  const std::vector<IDNode *>& ids, TypeContext * typesIn,
+  const SourceManager * srcIn, const OutputCache * cache)
+: types(typesIn), src(srcIn){
+	std::vector<DeclNode *> decls(ast->getGlobals()->begin(),
+	  ast->getGlobals()->end());
+	//The signature of each global name as of the declaration
+	// being looked at. A function's own signature goes in before
+	// its fingerprint is taken, since its body can call it.
+	std::unordered_map<NameID, std::string> sigs;
+	size_t nextID = 0;
+	for (size_t i = 0; i < decls.size(); i++){
+		DeclNode * decl = decls[i];
+		FnDeclNode * fn = decl->asFnDecl();
+		IDNode * name = fn != nullptr ? fn->ID()
+		  : static_cast<VarDeclNode *>(decl)->ID();
+		sigs[name->getIdent().id()] = signature(decl);
+		if (fn == nullptr){ continue; }
+
+		//The function's text runs up to the next declaration
+		size_t spanEnd = src->size();
+		if (i + 1 < decls.size()){ spanEnd = decls[i + 1]->offset(); }
+		std::string key = fingerprint(fn, spanEnd, ids, nextID, sigs);
+		fingerprints[fn->nodeID()] = key;
+
+		std::string text;
+		ProcTemplate tmpl;
+		if (cache->lookup(key, text, PROC_EXT) && readTemplate(text, tmpl)){
+			hits.emplace(fn->nodeID(), std::move(tmpl));
+		}
+	}
+}
+
+const ProcTemplate * IncrementalPlan::reused(NodeID fn) const {
+	auto found = hits.find(fn);
+	if (found == hits.end()){ return nullptr; }
+	return &found->second;
+}
+
+void IncrementalPlan::storeFresh(IRProgram * prog,
+  const OutputCache * cache) const {
+	for (Procedure * proc : prog->getProcs()){
+		const ASTNode * decl = proc->getDecl();
+		if (proc->isSpliced() || decl == nullptr){ continue; }
+		auto found = fingerprints.find(decl->nodeID());
+		if (found == fingerprints.end()){ continue; }
+		cache->store(found->second, writeTemplate(proc->toTemplate()),
+		  PROC_EXT);
+	}
+}
+
+std::string IncrementalPlan::typeCode(TypeNode * typeNode) const {
+	return typeNode->getType(types)->getString();
+}
+
+std::string IncrementalPlan::signature(DeclNode * decl) const {
+	FnDeclNode * fn = decl->asFnDecl();
+	if (fn == nullptr){
+		return "v" + typeCode(static_cast<VarDeclNode *>(decl)->getTypeNode());
+	}
+	std::string res = "f" + typeCode(fn->getRetTypeNode()) + "(";
+	bool first = true;
+	for (FormalDeclNode * formal : *fn->getFormals()){
+		if (!first){ res += ","; }
+		first = false;
+		res += typeCode(formal->getTypeNode());
+	}
+	return res + ")";
+}
+
+std::string IncrementalPlan::fingerprint(FnDeclNode * fn, size_t spanEnd,
+  const std::vector<IDNode *>& ids, size_t& next,
+  const std::unordered_map<NameID, std::string>& sigs) const {
+	Digest digest;
+	digest.add(compilerID());
+	digest.add(std::string(PROC_EXT));
+	SrcOffset start = fn->offset();
+	digest.add(std::string(src->data() + start, spanEnd - start));
+
+	//Each name the function uses, in the order first used, with
+	// what it meant globally. A name that is really a formal or
+	// local only costs a spurious miss if its global changes.
+	std::unordered_set<NameID> seen;
+	while (next < ids.size() && ids[next]->offset() < start){ next++; }
+	for (; next < ids.size() && ids[next]->offset() < spanEnd; next++){
+		Ident name = ids[next]->getIdent();
+		if (seen.insert(name.id()).second){
+			digest.add(name.text());
+			auto sig = sigs.find(name.id());
+			digest.add(sig == sigs.end() ? std::string("-") : sig->second);
+		}
+	}
+	return digest.hex();
+}
+
+}
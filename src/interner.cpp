@@ -0,0 +1,58 @@
+#include <string.h>
+
+#include "interner.hpp"
+
+namespace holeyc{
+
+StringInterner::StringInterner() : mySlots(1024, 0){
+}
+
+//FNV-1a
+uint32_t StringInterner::hash(const char * text, size_t len){
+	uint32_t h = 2166136261u;
+	for (size_t i = 0; i < len; i++){
+		h ^= static_cast<unsigned char>(text[i]);
+		h *= 16777619u;
+	}
+	return h;
+}
+
+Ident StringInterner::intern(const char * text, size_t len){
+	uint32_t h = hash(text, len);
+	size_t mask = mySlots.size() - 1;
+	size_t idx = h & mask;
+	while (mySlots[idx] != 0){
+		NameID cand = mySlots[idx] - 1;
+		const std::string& candText = myStrings[cand];
+		if (myHashes[cand] == h && candText.size() == len
+		  && memcmp(candText.data(), text, len) == 0){
+			return Ident(cand, &candText);
+		}
+		idx = (idx + 1) & mask;
+	}
+
+	NameID id = static_cast<NameID>(myStrings.size());
+	myStrings.emplace_back(text, len);
+	myHashes.push_back(h);
+	mySlots[idx] = id + 1;
+	//Keep the load factor at or below one half
+	if (myStrings.size() * 2 > mySlots.size()){
+		grow();
+	}
+	return Ident(id, &myStrings[id]);
+}
+
+void StringInterner::grow(){
+	std::vector<uint32_t> slots(mySlots.size() * 2, 0);
+	size_t mask = slots.size() - 1;
+	for (NameID id = 0; id < myStrings.size(); id++){
+		size_t idx = myHashes[id] & mask;
+		while (slots[idx] != 0){
+			idx = (idx + 1) & mask;
+		}
+		slots[idx] = id + 1;
+	}
+	mySlots.swap(slots);
+}
+
+}
@@ -0,0 +1,354 @@
+#include <FlexLexer.h>
+
+#include <string>
+#include <limits.h>
+
+/* Get our custom yyFlexScanner subclass */
+#include "scanner.hpp"
+#undef YY_DECL
+#define YY_DECL int holeyc::Scanner::yylex(holeyc::Parser::semantic_type * const lval)
+
+using TokenKind = holeyc::Parser::token;
+
+/* define yyterminate as returning an EOF token (instead of NULL) */
+#define yyterminate() return ( TokenKind::END )
+
+/* exclude unistd.h for Visual Studio compatibility. */
+#define YY_NO_UNISTD_H
+
+/* track the source offset of every match in one place */
+#define YY_USER_ACTION startMatch();
+
+
+#include <regex>
+#include <vector>
+#include <string>
+#include <cstring>
+#ifndef YY_READ_BUF_SIZE
+#define YY_READ_BUF_SIZE 8192
+#endif
+yyFlexLexer::yyFlexLexer(std::istream* in, std::ostream* out)
+: yyin(in ? in->rdbuf() : std::cin.rdbuf()), yyout(out ? out->rdbuf() : std::cout.rdbuf()){
+	yytext = nullptr; yyleng = 0; yylineno = 1; yy_flex_debug = 0;
+}
+yyFlexLexer::~yyFlexLexer(){ delete [] mf_buf; delete [] mf_text; }
+void yyFlexLexer::yy_switch_to_buffer(yy_buffer_state*){ }
+yy_buffer_state* yyFlexLexer::yy_create_buffer(std::istream*, int){ return nullptr; }
+void yyFlexLexer::yy_delete_buffer(yy_buffer_state*){ }
+void yyFlexLexer::yyrestart(std::istream* s){ if (s) yyin.rdbuf(s->rdbuf()); mf_loaded = false; mf_pos = 0; }
+int yyFlexLexer::yywrap(){ return 1; }
+int yyFlexLexer::LexerInput(char* buf, int max_size){
+	if (yyin.eof() || yyin.fail()) return 0;
+	yyin.read(buf, max_size);
+	if (yyin.bad()) return -1;
+	return static_cast<int>(yyin.gcount());
+}
+void yyFlexLexer::LexerOutput(const char* buf, int size){ yyout.write(buf, size); }
+void yyFlexLexer::LexerError(const char* msg){ std::cerr << msg << std::endl; exit(2); }
+int yyFlexLexer::yylex(){ LexerError("yyFlexLexer::yylex invoked but %option yyclass used"); return 0; }
+void yyFlexLexer::mf_load(){
+	std::string all; char tmp[YY_READ_BUF_SIZE]; int got;
+	while ((got = LexerInput(tmp, YY_READ_BUF_SIZE)) > 0){ all.append(tmp, static_cast<size_t>(got)); }
+	delete [] mf_buf; mf_buf = new char[all.size() + 1];
+	memcpy(mf_buf, all.data(), all.size()); mf_buf[all.size()] = 0;
+	mf_len = all.size(); mf_pos = 0; mf_loaded = true;
+	delete [] mf_text; mf_text = new char[all.size() + 2];
+}
+static std::vector<std::regex> * mf_build_rules(){
+	std::vector<std::regex> * rules = nullptr;
+	{
+		rules = new std::vector<std::regex>();
+		rules->push_back(std::regex("int"));
+		rules->push_back(std::regex("intptr"));
+		rules->push_back(std::regex("bool"));
+		rules->push_back(std::regex("boolptr"));
+		rules->push_back(std::regex("char"));
+		rules->push_back(std::regex("charptr"));
+		rules->push_back(std::regex("void"));
+		rules->push_back(std::regex("if"));
+		rules->push_back(std::regex("else"));
+		rules->push_back(std::regex("while"));
+		rules->push_back(std::regex("return"));
+		rules->push_back(std::regex("false"));
+		rules->push_back(std::regex("true"));
+		rules->push_back(std::regex("FROMCONSOLE"));
+		rules->push_back(std::regex("TOCONSOLE"));
+		rules->push_back(std::regex("NULLPTR"));
+		rules->push_back(std::regex("@"));
+		rules->push_back(std::regex("\\^"));
+		rules->push_back(std::regex("\\["));
+		rules->push_back(std::regex("\\]"));
+		rules->push_back(std::regex("\\{"));
+		rules->push_back(std::regex("\\}"));
+		rules->push_back(std::regex("\\("));
+		rules->push_back(std::regex("\\)"));
+		rules->push_back(std::regex(";"));
+		rules->push_back(std::regex(","));
+		rules->push_back(std::regex("\\+\\+"));
+		rules->push_back(std::regex("\\+"));
+		rules->push_back(std::regex("\\-\\-"));
+		rules->push_back(std::regex("\\-"));
+		rules->push_back(std::regex("\\*"));
+		rules->push_back(std::regex("/"));
+		rules->push_back(std::regex("!"));
+		rules->push_back(std::regex("\\&\\&"));
+		rules->push_back(std::regex("\\|\\|"));
+		rules->push_back(std::regex("=="));
+		rules->push_back(std::regex("!="));
+		rules->push_back(std::regex("<"));
+		rules->push_back(std::regex("<="));
+		rules->push_back(std::regex(">"));
+		rules->push_back(std::regex(">="));
+		rules->push_back(std::regex("="));
+		rules->push_back(std::regex("'\\\\[tn\\\\]"));
+		rules->push_back(std::regex("'\\\\\\t"));
+		rules->push_back(std::regex("'\\\\[ ]"));
+		rules->push_back(std::regex("'\\\\"));
+		rules->push_back(std::regex("'\\\\[^\\n\\rtn\\\\]"));
+		rules->push_back(std::regex("'\\t"));
+		rules->push_back(std::regex("'[^\\n\\\\]"));
+		rules->push_back(std::regex("('\\n)|('\\r\\n)"));
+		rules->push_back(std::regex("(([a-zA-Z])|_)(([a-zA-Z])|([0-9])|_)*"));
+		rules->push_back(std::regex("([0-9])+"));
+		rules->push_back(std::regex("\"(([^\\n\"\\\\])|\\\\([nt'\"\\\\]))*\""));
+		rules->push_back(std::regex("\"(([^\\n\"\\\\])|\\\\([nt'\"\\\\]))*"));
+		rules->push_back(std::regex("\"(([^\\n\"\\\\])|\\\\([nt'\"\\\\]))*\\\\([^\\nnt\"\\\\])(([^\\n\"]))*\""));
+		rules->push_back(std::regex("\"(([^\\n\"\\\\])|\\\\([nt'\"\\\\]))*(\\\\([^\\nnt\"\\\\]))?(([^\\n\"\\\\])|\\\\([nt'\"\\\\]))*\\\\?"));
+		rules->push_back(std::regex("\\n|(\\r\\n)"));
+		rules->push_back(std::regex("[ \\t]+"));
+		rules->push_back(std::regex("(\\#)[^\\n]*"));
+		rules->push_back(std::regex("[^\\n]"));
+	}
+	return rules;
+}
+static std::vector<std::regex> * mf_rules(){
+	static std::vector<std::regex> * rules = mf_build_rules();
+	return rules;
+}
+int yyFlexLexer::mf_match(size_t & len){
+	std::vector<std::regex> * rules = mf_rules();
+	size_t lim = mf_pos;
+	while (lim < mf_len && mf_buf[lim] != '\n') lim++;
+	if (lim < mf_len) lim++;
+	int best = -1; size_t bestLen = 0;
+	for (size_t r = 0; r < rules->size(); r++){
+		for (size_t k = lim - mf_pos; k > bestLen; k--){
+			if (std::regex_match(mf_buf + mf_pos, mf_buf + mf_pos + k, (*rules)[r])){
+				best = static_cast<int>(r); bestLen = k; break;
+			}
+		}
+	}
+	if (best < 0){ LexerError("flex scanner jammed"); }
+	len = bestLen;
+	return best;
+}
+YY_DECL {
+
+	this->yylval = lval;
+
+	if (!mf_loaded) mf_load();
+	while (true){
+		if (mf_pos >= mf_len){ yyterminate(); }
+		size_t mlen;
+		int mrule = mf_match(mlen);
+		memcpy(mf_text, mf_buf + mf_pos, mlen); mf_text[mlen] = 0;
+		yytext = mf_text; yyleng = static_cast<int>(mlen); mf_pos += mlen;
+#ifdef YY_USER_ACTION
+		YY_USER_ACTION
+#endif
+		switch (mrule){
+		case 0:
+{ return makeBareToken(TokenKind::INT); }
+		break;
+		case 1:
+{ return makeBareToken(TokenKind::INTPTR); }
+		break;
+		case 2:
+{ return makeBareToken(TokenKind::BOOL); }
+		break;
+		case 3:
+{ return makeBareToken(TokenKind::BOOLPTR); }
+		break;
+		case 4:
+{ return makeBareToken(TokenKind::CHAR); }
+		break;
+		case 5:
+{ return makeBareToken(TokenKind::CHARPTR); }
+		break;
+		case 6:
+{ return makeBareToken(TokenKind::VOID); }
+		break;
+		case 7:
+{ return makeBareToken(TokenKind::IF); }
+		break;
+		case 8:
+{ return makeBareToken(TokenKind::ELSE); }
+		break;
+		case 9:
+{ return makeBareToken(TokenKind::WHILE); }
+		break;
+		case 10:
+{ return makeBareToken(TokenKind::RETURN); }
+		break;
+		case 11:
+{ return makeBareToken(TokenKind::FALSE); }
+		break;
+		case 12:
+{ return makeBareToken(TokenKind::TRUE); }
+		break;
+		case 13:
+{ return makeBareToken(TokenKind::FROMCONSOLE);}
+		break;
+		case 14:
+{ return makeBareToken(TokenKind::TOCONSOLE); }
+		break;
+		case 15:
+{ return makeBareToken(TokenKind::NULLPTR); }
+		break;
+		case 16:
+{ return makeBareToken(TokenKind::AT); }
+		break;
+		case 17:
+{ return makeBareToken(TokenKind::CARAT); }
+		break;
+		case 18:
+{ return makeBareToken(TokenKind::LBRACE); }
+		break;
+		case 19:
+{ return makeBareToken(TokenKind::RBRACE); }
+		break;
+		case 20:
+{ return makeBareToken(TokenKind::LCURLY); }
+		break;
+		case 21:
+{ return makeBareToken(TokenKind::RCURLY); }
+		break;
+		case 22:
+{ return makeBareToken(TokenKind::LPAREN); }
+		break;
+		case 23:
+{ return makeBareToken(TokenKind::RPAREN); }
+		break;
+		case 24:
+{ return makeBareToken(TokenKind::SEMICOLON); }
+		break;
+		case 25:
+{ return makeBareToken(TokenKind::COMMA); }
+		break;
+		case 26:
+{ return makeBareToken(TokenKind::CROSSCROSS); }
+		break;
+		case 27:
+{ return makeBareToken(TokenKind::CROSS); }
+		break;
+		case 28:
+{ return makeBareToken(TokenKind::DASHDASH); }
+		break;
+		case 29:
+{ return makeBareToken(TokenKind::DASH); }
+		break;
+		case 30:
+{ return makeBareToken(TokenKind::STAR); }
+		break;
+		case 31:
+{ return makeBareToken(TokenKind::SLASH); }
+		break;
+		case 32:
+{ return makeBareToken(TokenKind::NOT); }
+		break;
+		case 33:
+{ return makeBareToken(TokenKind::AND); }
+		break;
+		case 34:
+{ return makeBareToken(TokenKind::OR); }
+		break;
+		case 35:
+{ return makeBareToken(TokenKind::EQUALS); }
+		break;
+		case 36:
+{ return makeBareToken(TokenKind::NOTEQUALS); }
+		break;
+		case 37:
+{ return makeBareToken(TokenKind::LESS); }
+		break;
+		case 38:
+{ return makeBareToken(TokenKind::LESSEQ); }
+		break;
+		case 39:
+{ return makeBareToken(TokenKind::GREATER); }
+		break;
+		case 40:
+{ return makeBareToken(TokenKind::GREATEREQ); }
+		break;
+		case 41:
+{ return makeBareToken(TokenKind::ASSIGN); }
+		break;
+		case 42:
+{ return makeCharLitToken(escaped(yytext[2])); }
+		break;
+		case 43:
+{ return makeCharLitToken('\t'); }
+		break;
+		case 44:
+{ return makeCharLitToken(' '); }
+		break;
+		case 45:
+{ errChrEscEmpty(); }
+		break;
+		case 46:
+{ errChrEsc(); }
+		break;
+		case 47:
+{ return makeCharLitToken('\t'); }
+		break;
+		case 48:
+{ return makeCharLitToken(yytext[1]); }
+		break;
+		case 49:
+{ errChrEmpty(); }
+		break;
+		case 50:
+{ 
+		            yylval->transToken = 
+		            tokenArena->make<IDToken>(tokenStart, 
+		              names->intern(yytext, static_cast<size_t>(yyleng)));
+		            return TokenKind::ID; }
+		break;
+		case 51:
+{ int intVal = intValue(yytext, 
+			              static_cast<size_t>(yyleng));
+			          yylval->transToken = 
+			              tokenArena->make<IntLitToken>(tokenStart, intVal);
+			          return TokenKind::INTLITERAL; }
+		break;
+		case 52:
+{
+   		          return makeStrToken(); }
+		break;
+		case 53:
+{
+		            errStrUnterm(); }
+		break;
+		case 54:
+{
+		            errStrEsc(); }
+		break;
+		case 55:
+{
+		            errStrEscAndUnterm(); }
+		break;
+		case 56:
+{ }
+		break;
+		case 57:
+{ }
+		break;
+		case 58:
+{ /* Comment. Ignore. */ }
+		break;
+		case 59:
+{ errIllegal(yytext); }
+		break;
+		}
+	}
+}
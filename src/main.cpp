@@ -1,22 +1,53 @@
 #include <fstream>
+#include <stdlib.h>
 #include <string.h>
 
-#include "errors.hpp"
-#include "scanner.hpp"
-#include "ast.hpp"
-#include "name_analysis.hpp"
-#include "type_analysis.hpp"
+#include "driver.hpp"
+#include "server.hpp"
 
 using namespace holeyc;
 
 static void usageAndDie(){
 	std::cerr << "Usage: holeycc <infile> <options>\n"
 	<< " [-t <tokensFile>]: Output tokens to <tokensFile>\n"
+	<< " [-T <tokenFile>]: Output tokens in binary to <tokenFile>,\n"
+	<< "   which --tokens-from can read back\n"
 	<< " [-p]: Parse the input to check syntax\n"
 	<< " [-u <unparseFile>]: Unparse to <unparseFile>\n"
 	<< " [-n <nameFile]: Output name analysis to <namesFile>\n"
 	<< " [-c]: Do type checking\n"
 	<< " [-a <3ACFile>]: Output 3AC program to <3ACFile>\n"
+	<< " [--cache-dir <dir>]: Reuse the 3AC of identical inputs\n"
+	<< "   compiled before, kept in <dir>\n"
+	<< " [--stream]: With -c or -a, compile one top-level\n"
+	<< "   declaration at a time, to bound memory use\n"
+	<< " [-j <threads>]: Lex alongside parsing (or, with the\n"
+	<< "   hand-written scanner, split up for large inputs), and\n"
+	<< "   analyze and lower the functions, on <threads>\n"
+	<< "   threads; -j 1 does it all in one\n"
+	<< " [--parallel]: As -j, with a thread per core\n"
+	<< " [--lexer hand|flex]: Lex with the hand-written scanner\n"
+	<< "   or the one flex generates (the default); both give\n"
+	<< "   the same tokens\n"
+	<< " [--tokens-from <tokenFile>]: Take the tokens from a file\n"
+	<< "   -T wrote for this input instead of lexing it\n"
+	<< "\n"
+	<< "       holeycc --batch [-j <threads>] [--cache-dir <dir>]\n"
+	<< "         [--stream] [--lexer hand|flex]\n"
+	<< "         <options> <inputs>\n"
+	<< " Compile every input (or every input listed in an\n"
+	<< " @<responseFile>) on a pool of threads. Each output\n"
+	<< " named by -t, -u, -n or -a (which take no file here)\n"
+	<< " is written next to its input as .tokens, .unparse,\n"
+	<< " .names or .3ac; diagnostics go to .err.\n"
+	<< "\n"
+	<< "       holeycc --serve <socket> [-j <threads>]\n"
+	<< " Keep a compiler resident, serving requests on the\n"
+	<< " Unix domain socket <socket>.\n"
+	<< "\n"
+	<< "       holeycc --client <socket> <infile> <options>\n"
+	<< " Compile <infile> on the server at <socket>; the\n"
+	<< " options and outputs are as for a single input.\n"
 	<< "\n"
 	;
 	std::cout << std::flush;
@@ -24,115 +55,90 @@ static void usageAndDie(){
 	exit(1);
 }
 
-static void doTokenization(std::ifstream * input, const char * outPath){
-	holeyc::Scanner scanner(input);
-	if (strcmp(outPath, "--") == 0){
-		scanner.outputTokens(std::cout);
-	} else {
-		std::ofstream outStream(outPath);
-		if (!outStream.good()){
-			std::string msg = "Bad output file ";
-			msg += outPath;
-			throw new holeyc::InternalError(msg.c_str());
-		}
-		scanner.outputTokens(outStream);
-	}
+//The scanner named by a --lexer argument
+static LexerKind lexerNamed(const char * name){
+	if (strcmp(name, "hand") == 0){ return LexerKind::HAND; }
+	if (strcmp(name, "flex") == 0){ return LexerKind::FLEX; }
+	std::cerr << "Unknown lexer " << name << "\n";
+	usageAndDie();
+	return DEFAULT_LEXER;
 }
 
-static holeyc::ProgramNode * syntacticAnalysis(std::ifstream * input){
-	if (input == nullptr){
-		return nullptr;
+//Add the inputs listed in a response file, separated by
+// whitespace
+static void readResponseFile(const char * path, 
+  std::vector<std::string>& inputs){
+	std::ifstream in(path);
+	if (!in.good()){
+		std::cerr << "Bad response file " << path << std::endl;
+		usageAndDie();
 	}
-
-	holeyc::ProgramNode * root = nullptr;
-
-	holeyc::Scanner scanner(input);
-	#if 1
-	holeyc::Parser parser(scanner, &root);
-	#else
-	holeyc::Parser parser(scanner);
-	#endif
-
-	int errCode = parser.parse();
-	if (errCode != 0) { 
-		return nullptr; 
+	std::string input;
+	while (in >> input){
+		inputs.push_back(input);
 	}
-	
-	return root;
 }
 
-static void outputAST(ASTNode * ast, const char * outPath){
-	if (strcmp(outPath, "--") == 0){
-		ast->unparse(std::cout, 0);
-	} else {
-		std::ofstream outStream(outPath);
-		if (!outStream.good()){
-			std::string msg = "Bad output file ";
-			msg += outPath;
-			throw new holeyc::InternalError(msg.c_str());
+static int batchMain(int argc, char * argv[]){
+	holeyc::BatchOptions opts;
+	std::vector<std::string> inputs;
+	bool useful = false;
+	for (int i = 2; i < argc; i++){
+		if (argv[i][0] == '@'){
+			readResponseFile(argv[i] + 1, inputs);
+		} else if (argv[i][0] != '-'){
+			inputs.push_back(argv[i]);
+		} else if (strcmp(argv[i], "--cache-dir") == 0){
+			i++;
+			if (i >= argc){ usageAndDie(); }
+			opts.cacheDir = argv[i];
+		} else if (strcmp(argv[i], "--stream") == 0){
+			opts.stream = true;
+		} else if (strcmp(argv[i], "--lexer") == 0){
+			i++;
+			if (i >= argc){ usageAndDie(); }
+			opts.lexer = lexerNamed(argv[i]);
+		} else if (strcmp(argv[i], "-j") == 0){
+			i++;
+			if (i >= argc){ usageAndDie(); }
+			int threads = atoi(argv[i]);
+			if (threads <= 0){ usageAndDie(); }
+			opts.threads = static_cast<size_t>(threads);
+		} else if (strcmp(argv[i], "-t") == 0){
+			opts.tokens = useful = true;
+		} else if (strcmp(argv[i], "-p") == 0){
+			opts.checkParse = useful = true;
+		} else if (strcmp(argv[i], "-u") == 0){
+			opts.unparse = useful = true;
+		} else if (strcmp(argv[i], "-n") == 0){
+			opts.names = useful = true;
+		} else if (strcmp(argv[i], "-c") == 0){
+			opts.checkTypes = useful = true;
+		} else if (strcmp(argv[i], "-a") == 0){
+			opts.threeAC = useful = true;
+		} else {
+			std::cerr << "Unknown option"
+			  << " " << argv[i] << "\n";
+			usageAndDie();
 		}
-		ast->unparse(outStream, 0);
 	}
-}
-
-static bool doUnparsing(std::ifstream * input, const char * outPath){
-	holeyc::ProgramNode * ast = syntacticAnalysis(input);
-	if (ast == nullptr){ 
-		std::cerr << "No AST built\n";
-		return false;
-	}
-	if (input == nullptr){ 
-		return false; 
-	}
-
-	outputAST(ast, outPath);
-	return true;
-}
-
-static holeyc::NameAnalysis * doNameAnalysis(std::ifstream * input){
-	holeyc::ProgramNode * ast = syntacticAnalysis(input);
-	if (ast == nullptr){ return nullptr; }
-
-	return holeyc::NameAnalysis::build(ast);
-}
 
-static holeyc::TypeAnalysis * doTypeAnalysis(std::ifstream * input){
-	holeyc::NameAnalysis * nameAnalysis = doNameAnalysis(input);
-	if (nameAnalysis == nullptr){ return nullptr; }
-
-	return holeyc::TypeAnalysis::build(nameAnalysis);
-}
-
-static holeyc::IRProgram * do3AC(std::ifstream * input){
-	holeyc::TypeAnalysis * typeAnalysis = doTypeAnalysis(input);
-	if (typeAnalysis == nullptr){ return nullptr; }
-
-	return typeAnalysis->ast->to3AC(typeAnalysis);
-}
-
-static void write3AC(holeyc::IRProgram * prog, const char * outPath){
-	if (outPath == nullptr){
-		throw new InternalError("Null 3AC file given");
-	}
-	std::string flatProg = prog->toString();
-	if (strcmp(outPath, "--") == 0){
-		std::cout << flatProg << std::endl;
-	} else {
-		std::ofstream outStream(outPath);
-		outStream << flatProg << std::endl;
-		outStream.close();
+	if (useful == false){
+		std::cerr << "You didn't specify an operation to do!\n";
+		usageAndDie();
 	}
-}
-
-int main(int argc, char * argv[]){
-	if (argc <= 1){ usageAndDie(); }
-	std::ifstream * input = new std::ifstream(argv[1]);
-	if (input == NULL){ usageAndDie(); }
-	if (!input->good()){
-		std::cerr << "Bad path " <<  argv[1] << std::endl;
+	if (inputs.empty()){
+		std::cerr << "No input files given\n";
 		usageAndDie();
 	}
+	return holeyc::runBatch(inputs, opts);
+}
 
+//Parse the options of a single-input run, starting from
+// argv[first]. Arguments that aren't options are skipped.
+// Returns false if no operation was asked for.
+static bool parseOptions(int argc, char * argv[], int first,
+  holeyc::DriverOptions& opts){
 	const char * tokensFile = nullptr; // Output file if 
 	                                   // printing tokens
 	bool checkParse = false;	   // Flag set if doing 
@@ -147,15 +153,41 @@ int main(int argc, char * argv[]){
 					   // syntactic analysis
 	const char * threeACFile = NULL;	   // Output file if doing
 					   // 3AC conversion
-	for (int i = 1; i < argc; i++){
-		if (argv[i][0] == '-'){
+	for (int i = first; i < argc; i++){
+		if (strcmp(argv[i], "--cache-dir") == 0){
+			i++;
+			if (i >= argc){ usageAndDie(); }
+			opts.cacheDir = argv[i];
+		} else if (strcmp(argv[i], "--stream") == 0){
+			opts.stream = true;
+		} else if (strcmp(argv[i], "--parallel") == 0){
+			opts.threads = 0;
+		} else if (strcmp(argv[i], "-j") == 0){
+			i++;
+			if (i >= argc){ usageAndDie(); }
+			int threads = atoi(argv[i]);
+			if (threads <= 0){ usageAndDie(); }
+			opts.threads = static_cast<size_t>(threads);
+		} else if (strcmp(argv[i], "--lexer") == 0){
+			i++;
+			if (i >= argc){ usageAndDie(); }
+			opts.lexer = lexerNamed(argv[i]);
+		} else if (strcmp(argv[i], "--tokens-from") == 0){
+			i++;
+			if (i >= argc){ usageAndDie(); }
+			opts.tokenFileIn = argv[i];
+		} else if (argv[i][0] == '-'){
 			if (argv[i][1] == 't'){
 				i++;
 				if (i >= argc){ usageAndDie(); }
 				tokensFile = argv[i];
 				useful = true;
-			} else if (argv[i][1] == 'p'){
+			} else if (argv[i][1] == 'T'){
 				i++;
+				if (i >= argc){ usageAndDie(); }
+				opts.tokenFileOut = argv[i];
+				useful = true;
+			} else if (argv[i][1] == 'p'){
 				checkParse = true;
 				useful = true;
 			} else if (argv[i][1] == 'u'){
@@ -169,7 +201,6 @@ int main(int argc, char * argv[]){
 				nameFile = argv[i];
 				useful = true;
 			} else if (argv[i][1] == 'c'){
-				i++;
 				checkTypes = true;
 				useful = true;
 			} else if (argv[i][1] == 'a'){
@@ -185,58 +216,63 @@ int main(int argc, char * argv[]){
 		}
 	}
 
-	if (useful == false){
+	opts.tokensFile = tokensFile;
+	opts.checkParse = checkParse;
+	opts.unparseFile = unparseFile;
+	opts.nameFile = nameFile;
+	opts.checkTypes = checkTypes;
+	opts.threeACFile = threeACFile;
+	return useful;
+}
+
+static int serveMain(int argc, char * argv[]){
+	if (argc < 3){ usageAndDie(); }
+	size_t threads = 0;
+	for (int i = 3; i < argc; i++){
+		if (strcmp(argv[i], "-j") != 0 || i + 1 >= argc){ usageAndDie(); }
+		int count = atoi(argv[++i]);
+		if (count <= 0){ usageAndDie(); }
+		threads = static_cast<size_t>(count);
+	}
+	return holeyc::runServer(argv[2], threads);
+}
+
+static int clientMain(int argc, char * argv[]){
+	if (argc < 4){ usageAndDie(); }
+	holeyc::DriverOptions opts;
+	if (!parseOptions(argc, argv, 4, opts)){
 		std::cerr << "You didn't specify an operation to do!\n";
 		usageAndDie();
 	}
+	//The protocol has no way to carry a token file either way
+	if (opts.tokenFileOut != nullptr || opts.tokenFileIn != nullptr){
+		std::cerr << "-T and --tokens-from aren't served remotely\n";
+		usageAndDie();
+	}
+	return holeyc::runClient(argv[2], argv[3], opts);
+}
 
-
-	try {
-		if (tokensFile != nullptr){
-			doTokenization(input, tokensFile);
-		}
-		if (checkParse){
-			if (!syntacticAnalysis(input)){
-				std::cerr << "Parse failed";
-			}
-		}
-		if (unparseFile != nullptr){
-			doUnparsing(input, unparseFile);
-		}
-		if (nameFile){
-			holeyc::NameAnalysis * na;
-			na = doNameAnalysis(input); 
-			if (na != nullptr){
-				outputAST(na->ast, nameFile);
-				return 0;
-			}
-			std::cerr << "Name Analysis Failed\n";
-			return 1;
-		}
-		if (checkTypes){
-			if (doTypeAnalysis(input) != nullptr){
-				return 0;
-			}
-			std::cerr << "Type Analysis Failed\n";
-			return 1;
-		}
-		if (threeACFile){
-			if (auto prog = do3AC(input)){
-				write3AC(prog, threeACFile);
-			}
-			if (doTypeAnalysis(input) != nullptr){
-				return 0;
-			}
-			std::cerr << "Type Analysis Failed\n";
-			return 1;
-		}
-	} catch (holeyc::ToDoError * e){
-		std::cerr << "ToDoError: " << e->msg() << "\n";
-		return 1;
-	} catch (holeyc::InternalError * e){
-		std::cerr << "InternalError: " << e->msg() << "\n";
-		return 1;
+int main(int argc, char * argv[]){
+	if (argc <= 1){ usageAndDie(); }
+	if (strcmp(argv[1], "--batch") == 0){
+		return batchMain(argc, argv);
+	}
+	if (strcmp(argv[1], "--serve") == 0){
+		return serveMain(argc, argv);
+	}
+	if (strcmp(argv[1], "--client") == 0){
+		return clientMain(argc, argv);
+	}
+	CompilationSession * session = new CompilationSession(argv[1]);
+	if (!session->good()){
+		std::cerr << "Bad path " <<  argv[1] << std::endl;
+		usageAndDie();
 	}
 
-	return 0;
+	holeyc::DriverOptions opts;
+	if (!parseOptions(argc, argv, 1, opts)){
+		std::cerr << "You didn't specify an operation to do!\n";
+		usageAndDie();
+	}
+	return holeyc::runSession(session, opts, std::cerr);
 }
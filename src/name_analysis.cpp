@@ -1,246 +1,396 @@
-#include "ast.hpp"
+#include <exception>
+#include <memory>
+
+#include "name_analysis.hpp"
 #include "symbol_table.hpp"
 #include "errName.hpp"
 #include "types.hpp"
+#include "incremental.hpp"
+#include "parallel.hpp"
 
 namespace holeyc{
 
-bool ProgramNode::nameAnalysis(SymbolTable * symTab){
-	//Enter the global scope
-	symTab->enterScope();
-	bool res = true;
-	for (auto decl : *myGlobals){
-		res = decl->nameAnalysis(symTab) && res;
+//The global scope of a program whose function bodies are
+// analyzed in parallel: each global name with its symbol and
+// the index of the declaration that bound it. A program binds
+// a global name at most once (declaring it again is an error),
+// so one entry per name is enough.
+class GlobalIndex{
+public:
+	void bind(Ident name, SemSymbol * symbol, size_t decl){
+		if (name.id() >= entries.size()){
+			entries.resize(name.id() + 1, Entry{nullptr, 0});
+		}
+		entries[name.id()] = Entry{symbol, decl};
+	}
+	//The global the name refers to from within the declaration
+	// at index decl
+	SemSymbol * find(Ident name, size_t decl) const {
+		if (name.id() >= entries.size()){ return nullptr; }
+		const Entry& entry = entries[name.id()];
+		if (entry.decl > decl){ return nullptr; }
+		return entry.symbol;
+	}
+private:
+	struct Entry{
+		SemSymbol * symbol;
+		size_t decl;
+	};
+	std::vector<Entry> entries;
+};
+
+NameAnalysis * NameAnalysis::build(ProgramNode * astIn,
+  CompilationContext * ctx, const IncrementalPlan * planIn,
+  size_t threads){
+	NameAnalysis * nameAnalysis = new NameAnalysis(astIn->nodeCount());
+	bool res;
+	if (threads == 1){
+		SymbolTable * symTab = new SymbolTable(&ctx->types);
+		NameWalker walker(&ctx->diags, symTab, &nameAnalysis->symbols,
+		  planIn);
+		res = astIn->nameAnalysis(&walker);
+		delete symTab;
+	} else {
+		try {
+			res = nameAnalysis->analyzeParallel(astIn, ctx, planIn, threads);
+		} catch (...){
+			delete nameAnalysis;
+			throw;
+		}
+	}
+	if (!res){
+		delete nameAnalysis;
+		return nullptr;
 	}
-	//Leave the global scope
-	symTab->leaveScope();
-	return res;
-}
 
-bool AssignStmtNode::nameAnalysis(SymbolTable * symTab){
-	return myExp->nameAnalysis(symTab);
+	nameAnalysis->ast = astIn;
+	nameAnalysis->context = ctx;
+	nameAnalysis->plan = planIn;
+	return nameAnalysis;
 }
 
-bool PostIncStmtNode::nameAnalysis(SymbolTable * symTab){
-	return myLVal->nameAnalysis(symTab);
-}
+bool NameAnalysis::analyzeParallel(ProgramNode * astIn,
+  CompilationContext * ctx, const IncrementalPlan * planIn,
+  size_t threads){
+	std::vector<DeclNode *> decls(astIn->getGlobals()->begin(),
+	  astIn->getGlobals()->end());
+	size_t count = decls.size();
+	//Each declaration's problems are recorded apart, then
+	// reported in order. If analyzing a declaration threw, the
+	// serial walk would have stopped there, so the rest are
+	// neither reported nor run.
+	std::vector<std::unique_ptr<Diagnostics>> diags(count);
+	std::vector<std::exception_ptr> thrown(count);
+	std::vector<char> ok(count, 1);
+	size_t stop = count;
+
+	//The globals go into their own scope, one after the other
+	GlobalIndex globals;
+	SymbolTable globalTab(&ctx->types);
+	globalTab.enterScope();
+	for (size_t i = 0; i < count; i++){
+		FnDeclNode * fn = decls[i]->asFnDecl();
+		diags[i].reset(new Diagnostics(ctx->source()));
+		NameWalker walker(diags[i].get(), &globalTab, &symbols, planIn);
+		IDNode * id;
+		try {
+			if (fn != nullptr){
+				ok[i] = walker.fnHeader(fn);
+				id = fn->ID();
+			} else {
+				ok[i] = decls[i]->nameAnalysis(&walker);
+				id = static_cast<VarDeclNode *>(decls[i])->ID();
+			}
+		} catch (...){
+			thrown[i] = std::current_exception();
+			stop = i;
+			break;
+		}
+		Ident name = id->getIdent();
+		SemSymbol * bound = globalTab.find(name);
+		if (bound != nullptr && globals.find(name, i) == nullptr){
+			globals.bind(name, bound, i);
+		}
+	}
+
+	//Then the function bodies, each in a table of its own
+	parallelFor(stop, threads, [&](size_t i){
+		FnDeclNode * fn = decls[i]->asFnDecl();
+		if (fn == nullptr){ return; }
+		if (planIn != nullptr && planIn->reused(fn->nodeID()) != nullptr){
+			return;
+		}
+		SymbolTable locals(&ctx->types);
+		NameWalker walker(diags[i].get(), &locals, &symbols, planIn);
+		walker.setGlobals(&globals, i);
+		try {
+			ok[i] = walker.fnBody(fn) && ok[i];
+		} catch (...){
+			thrown[i] = std::current_exception();
+		}
+	});
 
-bool PostDecStmtNode::nameAnalysis(SymbolTable * symTab){
-	return myLVal->nameAnalysis(symTab);
+	bool res = true;
+	for (size_t i = 0; i < count && i <= stop; i++){
+		ctx->diags.replay(*diags[i]);
+		if (thrown[i]){ std::rethrow_exception(thrown[i]); }
+		res = res && ok[i];
+	}
+	return res;
 }
 
-bool FromConsoleStmtNode::nameAnalysis(SymbolTable * symTab){
-	return myDst->nameAnalysis(symTab);
+GlobalNameScope::GlobalNameScope(CompilationContext * ctxIn,
+  Diagnostics * diagsIn)
+: ctx(ctxIn), diags(diagsIn), symTab(new SymbolTable(&ctxIn->types)){
+	symTab->enterScope();
 }
 
-bool ToConsoleStmtNode::nameAnalysis(SymbolTable * symTab){
-	return mySrc->nameAnalysis(symTab);
+GlobalNameScope::~GlobalNameScope(){
+	delete symTab;
 }
 
-bool IfStmtNode::nameAnalysis(SymbolTable * symTab){
-	bool result = true;
-	result = myCond->nameAnalysis(symTab) && result;
-	symTab->enterScope();
-	for (auto stmt : *myBody){
-		result = stmt->nameAnalysis(symTab) && result;
-	}	
-	symTab->leaveScope();
-	return result;
+NameAnalysis * GlobalNameScope::analyze(DeclNode * decl,
+  size_t nodeCount){
+	NameAnalysis * nameAnalysis = new NameAnalysis(nodeCount);
+	NameWalker walker(diags, symTab, &nameAnalysis->symbols, nullptr,
+	  &localSymbols);
+	if (!decl->nameAnalysis(&walker)){
+		delete nameAnalysis;
+		return nullptr;
+	}
+	nameAnalysis->ast = nullptr;
+	nameAnalysis->context = ctx;
+	nameAnalysis->plan = nullptr;
+	return nameAnalysis;
 }
 
-bool IfElseStmtNode::nameAnalysis(SymbolTable * symTab){
-	bool result = true;
-	result = myCond->nameAnalysis(symTab) && result;
-	symTab->enterScope();
-	for (auto stmt : *myBodyTrue){
-		result = stmt->nameAnalysis(symTab) && result;
-	}	
-	symTab->leaveScope();
-	symTab->enterScope();
-	for (auto stmt : *myBodyFalse){
-		result = stmt->nameAnalysis(symTab) && result;
-	}	
-	symTab->leaveScope();
-	return result;
+SemSymbol * NameWalker::lookup(Ident name) const {
+	SemSymbol * sym = symTab->find(name);
+	if (sym == nullptr && globals != nullptr){
+		sym = globals->find(name, globalsDecl);
+	}
+	return sym;
 }
 
-bool WhileStmtNode::nameAnalysis(SymbolTable * symTab){
-	bool result = true;
-	result = myCond->nameAnalysis(symTab) && result;
-	symTab->enterScope();
-	for (auto stmt : *myBody){
-		result = stmt->nameAnalysis(symTab) && result;
-	}	
-	symTab->leaveScope();
-	return result;
+bool NameWalker::id(IDNode * node){
+	SemSymbol * sym = lookup(node->getIdent());
+	if (sym == nullptr){
+		return NameErr::undeclID(*diags, node->offset());
+	}
+	(*symbols)[node] = sym;
+	return true;
 }
 
-bool VarDeclNode::nameAnalysis(SymbolTable * symTab){
-	DataType * dataType = getTypeNode()->getType();
-	std::string varName = ID()->getName();
+bool NameWalker::varDecl(VarDeclNode * decl){
+	DataType * dataType = decl->getTypeNode()->getType(symTab->types());
+	Ident varName = decl->ID()->getIdent();
 
 	bool validType = dataType->validVarType();
 	if (!validType){
-		NameErr::badVarType(line(), col()); 
+		NameErr::badVarType(*diags, decl->offset());
 	}
 
 	bool validName = !symTab->clash(varName);
-	if (!validName){ 
-		NameErr::multiDecl(ID()->line(), ID()->col()); 
+	if (!validName){
+		NameErr::multiDecl(*diags, decl->ID()->offset());
 	}
 
-	if (!validType || !validName){ 
-		return false; 
+	if (!validType || !validName){
+		return false;
 	} else {
-		symTab->insert(new VarSymbol(varName, dataType));
+		if (localSymbols != nullptr && symTab->depth() > 1){
+			symTab->insert(localSymbols->make<VarSymbol>(varName, dataType));
+		} else {
+			symTab->insert(new VarSymbol(varName, dataType));
+		}
 		return true;
 	}
 }
 
-bool FnDeclNode::nameAnalysis(SymbolTable * symTab){
-	std::string fnName = this->ID()->getName();
+bool NameWalker::fnDecl(FnDeclNode * fn){
+	bool validName = fnHeader(fn);
 
-	bool validRet = myRetType->nameAnalysis(symTab);
+	//A reused function's body was checked when it was cached
+	if (plan != nullptr && plan->reused(fn->nodeID()) != nullptr){
+		return validName;
+	}
 
-	// hold onto the scope of the function.
-	ScopeTable * atFnScope = symTab->getCurrentScope();
-	//Enter a new scope for "within" this function.
-	ScopeTable * inFnScope = symTab->enterScope();
+	bool validBody = fnBody(fn);
+	return validName && validBody;
+}
+
+bool NameWalker::fnHeader(FnDeclNode * fn){
+	Ident fnName = fn->ID()->getIdent();
 
-	/*Note that we check for a clash of the function 
+	/*Note that we check for a clash of the function
 	  name in it's declared scope (e.g. a global
 	  scope for a global function)
 	*/
 	bool validName = true;
-	if (atFnScope->clash(fnName)){
-		NameErr::multiDecl(ID()->line(), ID()->col()); 
+	if (symTab->clash(fnName)){
+		NameErr::multiDecl(*diags, fn->ID()->offset());
 		validName = false;
 	}
 
-	bool validFormals = true;
-	std::list<const DataType *> * formalTypes = 
-		new std::list<const DataType *>();
-	for (auto formal : *(this->myFormals)){
-		validFormals = formal->nameAnalysis(symTab) && validFormals;
+	std::vector<const DataType *> formalTypes;
+	for (auto formal : *fn->getFormals()){
 		TypeNode * typeNode = formal->getTypeNode();
-		const DataType * formalType = typeNode->getType();
-		formalTypes->push_back(formalType);
+		formalTypes.push_back(typeNode->getType(symTab->types()));
 	}
 
-
-	const DataType * retType = this->getRetTypeNode()->getType();
-	FnType * dataType = new FnType(formalTypes, retType);
-	//Make sure the fnSymbol is in the symbol table before 
-	// analyzing the body, to allow for recursive calls
+	const DataType * retType = 
+	  fn->getRetTypeNode()->getType(symTab->types());
+	FnType * dataType = symTab->types()->fn(formalTypes, retType);
+	//Make sure the fnSymbol is in the symbol table before
+	// analyzing the body, to allow for recursive calls. The
+	// symbol table only binds names in the innermost scope, so
+	// this has to happen before we enter the function's scope
 	if (validName){
-		atFnScope->addFn(fnName, dataType);
-	}
-
-	bool validBody = true;
-	for (auto stmt : *myBody){
-		validBody = stmt->nameAnalysis(symTab) && validBody;
+		symTab->addFn(fnName, dataType);
+		//Type analysis takes the function's type from here
+		(*symbols)[fn->ID()] = symTab->find(fnName);
 	}
+	return validName;
+}
 
+bool NameWalker::fnBody(FnDeclNode * fn){
+	//Enter a new scope for "within" this function.
+	symTab->enterScope();
+	bool validFormals = all(fn->getFormals());
+	bool validBody = all(fn->getBody());
 	symTab->leaveScope();
-	return (validRet && validFormals && validName && validBody);
+	return validFormals && validBody;
 }
 
-bool RefNode::nameAnalysis(SymbolTable * symTab){
-	return myID->nameAnalysis(symTab);
+bool ProgramNode::nameAnalysis(NameWalker * names){
+	//The globals make up the outermost scope
+	return names->scope(myGlobals);
 }
 
-bool DerefNode::nameAnalysis(SymbolTable * symTab){
-	return myID->nameAnalysis(symTab);
+bool VarDeclNode::nameAnalysis(NameWalker * names){
+	return names->varDecl(this);
 }
 
-bool IndexNode::nameAnalysis(SymbolTable * symTab){
-	bool res = true;
-	res = myBase->nameAnalysis(symTab) && res;
-	res = myOffset->nameAnalysis(symTab) && res;
-	return res;
+bool FnDeclNode::nameAnalysis(NameWalker * names){
+	return names->fnDecl(this);
 }
 
-bool BinaryExpNode::nameAnalysis(SymbolTable * symTab){
-	bool resultLHS = myExp1->nameAnalysis(symTab);
-	bool resultRHS = myExp2->nameAnalysis(symTab);
-	return resultLHS && resultRHS;
+bool AssignStmtNode::nameAnalysis(NameWalker * names){
+	return myExp->nameAnalysis(names);
 }
 
-bool CallExpNode::nameAnalysis(SymbolTable* symTab){
-	bool result = true;
-	result = myID->nameAnalysis(symTab) && result;
-	for (auto arg : *myArgs){
-		result = arg->nameAnalysis(symTab) && result;
-	}
-	return result;
+bool PostIncStmtNode::nameAnalysis(NameWalker * names){
+	return myLVal->nameAnalysis(names);
 }
 
-bool NegNode::nameAnalysis(SymbolTable* symTab){
-	return myExp->nameAnalysis(symTab);
+bool PostDecStmtNode::nameAnalysis(NameWalker * names){
+	return myLVal->nameAnalysis(names);
 }
 
-bool NotNode::nameAnalysis(SymbolTable* symTab){
-	return myExp->nameAnalysis(symTab);
+bool FromConsoleStmtNode::nameAnalysis(NameWalker * names){
+	return myDst->nameAnalysis(names);
 }
 
-bool AssignExpNode::nameAnalysis(SymbolTable* symTab){
-	bool result = true;
-	result = myDst->nameAnalysis(symTab) && result;
-	result = mySrc->nameAnalysis(symTab) && result;
+bool ToConsoleStmtNode::nameAnalysis(NameWalker * names){
+	return mySrc->nameAnalysis(names);
+}
+
+bool IfStmtNode::nameAnalysis(NameWalker * names){
+	bool result = myCond->nameAnalysis(names);
+	result = names->scope(myBody) && result;
 	return result;
 }
 
-bool ReturnStmtNode::nameAnalysis(SymbolTable * symTab){
+bool IfElseStmtNode::nameAnalysis(NameWalker * names){
+	bool result = myCond->nameAnalysis(names);
+	result = names->scope(myBodyTrue) && result;
+	result = names->scope(myBodyFalse) && result;
+	return result;
+}
+
+bool WhileStmtNode::nameAnalysis(NameWalker * names){
+	bool result = myCond->nameAnalysis(names);
+	result = names->scope(myBody) && result;
+	return result;
+}
+
+bool ReturnStmtNode::nameAnalysis(NameWalker * names){
 	if (myExp == nullptr){ // May happen in void functions
 		return true;
 	}
-	return myExp->nameAnalysis(symTab);
+	return myExp->nameAnalysis(names);
 }
 
-bool CallStmtNode::nameAnalysis(SymbolTable* symTab){
-	return myCallExp->nameAnalysis(symTab);
+bool CallStmtNode::nameAnalysis(NameWalker * names){
+	return myCallExp->nameAnalysis(names);
 }
 
-bool TypeNode::nameAnalysis(SymbolTable * symTab){
-	return true;
+bool RefNode::nameAnalysis(NameWalker * names){
+	return myID->nameAnalysis(names);
 }
 
-bool IntLitNode::nameAnalysis(SymbolTable * symTab){
-	return true;
+bool DerefNode::nameAnalysis(NameWalker * names){
+	return myID->nameAnalysis(names);
 }
 
-bool CharLitNode::nameAnalysis(SymbolTable * symTab){
+bool IndexNode::nameAnalysis(NameWalker * names){
+	bool res = myBase->nameAnalysis(names);
+	res = myOffset->nameAnalysis(names) && res;
+	return res;
+}
+
+bool BinaryExpNode::nameAnalysis(NameWalker * names){
+	bool resultLHS = myExp1->nameAnalysis(names);
+	bool resultRHS = myExp2->nameAnalysis(names);
+	return resultLHS && resultRHS;
+}
+
+bool UnaryExpNode::nameAnalysis(NameWalker * names){
+	return myExp->nameAnalysis(names);
+}
+
+bool CallExpNode::nameAnalysis(NameWalker * names){
+	bool result = myID->nameAnalysis(names);
+	result = names->all(myArgs) && result;
+	return result;
+}
+
+bool AssignExpNode::nameAnalysis(NameWalker * names){
+	bool result = myDst->nameAnalysis(names);
+	result = mySrc->nameAnalysis(names) && result;
+	return result;
+}
+
+bool IDNode::nameAnalysis(NameWalker * names){
+	return names->id(this);
+}
+
+bool TypeNode::nameAnalysis(NameWalker *){
 	return true;
 }
 
-bool StrLitNode::nameAnalysis(SymbolTable * symTab){
+bool IntLitNode::nameAnalysis(NameWalker *){
 	return true;
 }
 
-bool NullPtrNode::nameAnalysis(SymbolTable * symTab){
+bool CharLitNode::nameAnalysis(NameWalker *){
 	return true;
 }
 
-bool TrueNode::nameAnalysis(SymbolTable * symTab){
+bool StrLitNode::nameAnalysis(NameWalker *){
 	return true;
 }
 
-bool FalseNode::nameAnalysis(SymbolTable * symTab){
+bool NullPtrNode::nameAnalysis(NameWalker *){
 	return true;
 }
 
-bool IDNode::nameAnalysis(SymbolTable* symTab){
-	std::string myName = this->getName();
-	SemSymbol * sym = symTab->find(myName);
-	if (sym == nullptr){
-		return NameErr::undeclID(line(), col());
-	}
-	this->attachSymbol(sym);
+bool TrueNode::nameAnalysis(NameWalker *){
 	return true;
 }
 
-void IDNode::attachSymbol(SemSymbol * symbolIn){
-	this->mySymbol = symbolIn;
+bool FalseNode::nameAnalysis(NameWalker *){
+	return true;
 }
 
 }
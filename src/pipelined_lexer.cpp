@@ -0,0 +1,85 @@
+#include "pipelined_lexer.hpp"
+
+namespace holeyc{
+
+PipelinedLexer::PipelinedLexer(CompilationContext * ctxIn,
+  Arena * tokenArena)
+: ctx(ctxIn), lexDiags(ctxIn->source()),
+  lexer(Lexer::build(ctxIn, tokenArena)), ring(RING_TOKENS){
+	lexer->setDiagnostics(&lexDiags);
+	thread = std::thread(&PipelinedLexer::produce, this);
+}
+
+PipelinedLexer::~PipelinedLexer(){
+	finish();
+}
+
+//The scanner's thread. It always ends the stream with an END
+// token, even if the scanner threw or was stopped, so the parser
+// never waits on a scanner that has stopped. If it threw, the
+// END has no token
+void PipelinedLexer::produce(){
+	try {
+		while (!stopping.load(std::memory_order_relaxed)){
+			LexedToken tok = lexer->next();
+			ring.push(Lexed{tok, takeErrors()});
+			if (tok.kind == Parser::token::END){ return; }
+		}
+		ring.push(Lexed{LexedToken{Parser::token::END, nullptr}, nullptr});
+	} catch (...){
+		thrown = std::current_exception();
+		ring.push(Lexed{LexedToken{Parser::token::END, nullptr},
+		  takeErrors()});
+	}
+}
+
+//The errors the scanner reported since this was last called, or
+// nullptr if there were none
+std::vector<Diagnostic> * PipelinedLexer::takeErrors(){
+	const std::vector<Diagnostic>& all = lexDiags.all();
+	if (all.size() == errorsTaken){ return nullptr; }
+	std::vector<Diagnostic> * errors = new std::vector<Diagnostic>(
+	  all.begin() + static_cast<std::ptrdiff_t>(errorsTaken), all.end());
+	errorsTaken = all.size();
+	return errors;
+}
+
+int PipelinedLexer::yylex(Parser::semantic_type * const lval){
+	//Like TokenReplay, keep answering END once the stream ends
+	if (sawEnd){ return Parser::token::END; }
+	Lexed item = ring.pop();
+	if (item.errors != nullptr){
+		for (const Diagnostic& diag : *item.errors){
+			ctx->diags.report(diag);
+		}
+		delete item.errors;
+	}
+	LexedToken tok = item.tok;
+	if (tok.kind == Parser::token::END){ sawEnd = true; }
+	if (tok.token == nullptr){
+		finished = true;
+		thread.join();
+		std::rethrow_exception(thrown);
+	}
+	lval->transToken = tok.token;
+	myLastOffset = tok.token->offset();
+	return tok.kind;
+}
+
+void PipelinedLexer::drain(){
+	while (!sawEnd){
+		Lexed item = ring.pop();
+		delete item.errors;
+		sawEnd = item.tok.kind == Parser::token::END;
+	}
+}
+
+void PipelinedLexer::finish(){
+	if (finished){ return; }
+	finished = true;
+	stopping.store(true, std::memory_order_relaxed);
+	drain();
+	thread.join();
+}
+
+}
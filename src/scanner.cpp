@@ -1,25 +1,62 @@
 #include <fstream>
+#include <string.h>
 #include "scanner.hpp"
+#include "fast_scanner.hpp"
+#include "emitter.hpp"
 
 using namespace holeyc;
 
 using TokenKind = holeyc::Parser::token;
 using Lexeme = holeyc::Parser::semantic_type;
 
-void Scanner::outputTokens(std::ostream& outstream){
+int Scanner::LexerInput(char * buf, int maxSize){
+	if (myInput == nullptr){
+		return yyFlexLexer::LexerInput(buf, maxSize);
+	}
+	size_t remaining = myInputLen - myInputPos;
+	size_t count = static_cast<size_t>(maxSize);
+	if (remaining < count){ count = remaining; }
+	memcpy(buf, myInput + myInputPos, count);
+	myInputPos += count;
+	return static_cast<int>(count);
+}
+
+Lexer * Lexer::build(CompilationContext * ctx, Arena * tokenArena){
+	if (ctx->lexer == LexerKind::FLEX){
+		return new Scanner(ctx, tokenArena);
+	}
+	return new FastScanner(ctx, tokenArena);
+}
+
+LexedToken Lexer::next(){
 	Lexeme lexeme;
-	int tokenKind;
+	int tokenKind = this->yylex(&lexeme);
+	if (tokenKind == TokenKind::END){
+		Token * eof = tokenArena->make<Token>(nextOffset, 
+		  TokenKind::END);
+		return LexedToken{tokenKind, eof};
+	}
+	return LexedToken{tokenKind, lexeme.transToken};
+}
+
+void Lexer::lexAll(std::vector<LexedToken>& tokens, LexErrors& errors){
+	Diagnostics * reportTo = diags;
+	diags = errors.sink();
 	while(true){
-		tokenKind = this->yylex(&lexeme);
-		if (tokenKind == TokenKind::END){
-			outstream << "EOF" 
-			  << " [" << this->lineNum 
-			  << "," << this->colNum << "]"
-			  << std::endl;
-			return;
-		} else {
-			outstream << lexeme.transToken->toString()
-			  << std::endl;
-		}
+		tokens.push_back(next());
+		errors.mark(tokens.size() - 1);
+		if (tokens.back().kind == TokenKind::END){ break; }
+	}
+	diags = reportTo;
+}
+
+void Scanner::outputTokens(const std::vector<LexedToken>& tokens,
+  const SourceManager& src, std::ostream& outstream){
+	//A buffer at a time rather than a flush per token
+	Emitter emitter(outstream);
+	for (const LexedToken& tok : tokens){
+		emitter << tok.token->toString(src) << '\n';
 	}
+	emitter.flush();
+	outstream.flush();
 }
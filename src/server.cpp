@@ -0,0 +1,372 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "server.hpp"
+#include "cache.hpp"
+
+namespace holeyc{
+
+static const char * const PROTOCOL_VERSION = "holeycc-1";
+static const size_t REQUEST_STRINGS = 8;
+//The tokens, unparse, names and 3AC outputs
+static const unsigned long MAX_OUTPUT_FILES = 4;
+//The longest version, path or flags string a request may
+// carry; only the input text may run up to the 4GB that
+// SourceBuffer takes
+static const size_t MAX_FIELD_BYTES = 4096;
+static const size_t REQUEST_SOURCE = 2;
+static const size_t RECV_CHUNK_BYTES = 1 << 20;
+//The most threads a request may have its session use
+static const unsigned long MAX_SESSION_THREADS = 1024;
+
+//A worker starts over with a fresh ResidentState once this
+// many distinct names have piled up in the old one
+static const size_t MAX_RESIDENT_NAMES = 1 << 20;
+
+static bool sendAll(int fd, const char * data, size_t len){
+	while (len > 0){
+		ssize_t sent = send(fd, data, len, MSG_NOSIGNAL);
+		if (sent < 0 && errno == EINTR){ continue; }
+		if (sent <= 0){ return false; }
+		data += sent;
+		len -= static_cast<size_t>(sent);
+	}
+	return true;
+}
+
+static bool recvAll(int fd, char * data, size_t len){
+	while (len > 0){
+		ssize_t got = recv(fd, data, len, 0);
+		if (got < 0 && errno == EINTR){ continue; }
+		if (got <= 0){ return false; }
+		data += got;
+		len -= static_cast<size_t>(got);
+	}
+	return true;
+}
+
+static bool sendString(int fd, const std::string& str){
+	if (str.size() > UINT32_MAX){ return false; }
+	uint32_t len = static_cast<uint32_t>(str.size());
+	return sendAll(fd, reinterpret_cast<const char *>(&len), sizeof(len))
+	  && sendAll(fd, str.data(), str.size());
+}
+
+//Fails on a length over max. The string only grows as the
+// bytes arrive, so a length the peer never sends costs nothing,
+// and running out of memory fails the string, not the server.
+static bool recvString(int fd, std::string& str, size_t max){
+	uint32_t len;
+	if (!recvAll(fd, reinterpret_cast<char *>(&len), sizeof(len))){
+		return false;
+	}
+	if (len > max){ return false; }
+	str.clear();
+	size_t left = len;
+	try {
+		while (left > 0){
+			size_t got = str.size();
+			size_t chunk = std::min(left, RECV_CHUNK_BYTES);
+			str.resize(got + chunk);
+			if (!recvAll(fd, &str[got], chunk)){ return false; }
+			left -= chunk;
+		}
+	} catch (std::bad_alloc&){
+		return false;
+	}
+	return true;
+}
+
+//Parse a decimal number of at most max, as sent by the server
+static bool parseCount(const std::string& str, unsigned long max,
+  unsigned long& value){
+	if (str.empty() || str.size() > 10){ return false; }
+	value = 0;
+	for (char c : str){
+		if (c < '0' || c > '9'){ return false; }
+		value = value * 10 + static_cast<unsigned long>(c - '0');
+	}
+	return value <= max;
+}
+
+static bool socketAddress(const char * socketPath, sockaddr_un& addr){
+	if (strlen(socketPath) >= sizeof(addr.sun_path)){ return false; }
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, socketPath);
+	return true;
+}
+
+//Keeps each output in memory, for the response. Outputs sent
+// to "--" are collected with the rest of stdout.
+class MemoryOutputs : public OutputFiles{
+public:
+	virtual std::ostream * open(const char * path) override{
+		if (strcmp(path, "--") == 0){ return &stdoutText; }
+		paths.push_back(path);
+		texts.emplace_back(new std::ostringstream());
+		return texts.back().get();
+	}
+	std::ostringstream stdoutText;
+	std::vector<std::string> paths;
+	std::vector<std::unique_ptr<std::ostringstream>> texts;
+};
+
+//A response with no outputs, for a request that could not be
+// served
+static void sendError(int conn, const std::string& msg){
+	sendString(conn, PROTOCOL_VERSION)
+	  && sendString(conn, "1")
+	  && sendString(conn, "")
+	  && sendString(conn, msg + "\n")
+	  && sendString(conn, "0");
+}
+
+static void handleRequest(int conn, ResidentState * resident){
+	std::vector<std::string> req(REQUEST_STRINGS);
+	for (size_t i = 0; i < REQUEST_STRINGS; i++){
+		size_t max = i == REQUEST_SOURCE ? UINT32_MAX : MAX_FIELD_BYTES;
+		if (!recvString(conn, req[i], max)){
+			sendError(conn, "Request cut short or too large");
+			return;
+		}
+	}
+	if (req[0] != PROTOCOL_VERSION){
+		sendError(conn, "Server speaks " + std::string(PROTOCOL_VERSION)
+		  + ", not " + req[0]);
+		return;
+	}
+
+	DriverOptions opts;
+	if (!req[3].empty()){ opts.tokensFile = req[3].c_str(); }
+	if (!req[4].empty()){ opts.unparseFile = req[4].c_str(); }
+	if (!req[5].empty()){ opts.nameFile = req[5].c_str(); }
+	if (!req[6].empty()){ opts.threeACFile = req[6].c_str(); }
+	opts.checkParse = req[7].find('p') != std::string::npos;
+	opts.checkTypes = req[7].find('c') != std::string::npos;
+	opts.stream = req[7].find('s') != std::string::npos;
+	size_t threadFlag = req[7].find('j');
+	if (threadFlag != std::string::npos){
+		unsigned long threads;
+		if (!parseCount(req[7].substr(threadFlag + 1), MAX_SESSION_THREADS,
+		  threads)){
+			sendError(conn, "Bad thread count in " + req[7]);
+			return;
+		}
+		opts.threads = threads;
+	}
+	//The client's choice of scanner, which need not be the
+	// server's default
+	if (req[7].find('f') != std::string::npos){ opts.lexer = LexerKind::FLEX; }
+	if (req[7].find('h') != std::string::npos){ opts.lexer = LexerKind::HAND; }
+
+	MemoryOutputs outputs;
+	std::ostringstream errText;
+	int status;
+	{
+		//The session is done with the resident state before
+		// anyone else can get at it
+		SourceBuffer * source = SourceBuffer::borrow(req[2].data(),
+		  req[2].size());
+		CompilationSession session(source, req[1].c_str(), errText,
+		  outputs.stdoutText, resident);
+		if (session.good()){
+			status = runSession(&session, opts, errText, outputs);
+		} else {
+			errText << "Bad path " << req[1] << std::endl;
+			status = 1;
+		}
+	}
+
+	bool ok = sendString(conn, PROTOCOL_VERSION)
+	  && sendString(conn, std::to_string(status))
+	  && sendString(conn, outputs.stdoutText.str())
+	  && sendString(conn, errText.str())
+	  && sendString(conn, std::to_string(outputs.paths.size()));
+	for (size_t i = 0; ok && i < outputs.paths.size(); i++){
+		ok = sendString(conn, outputs.paths[i])
+		  && sendString(conn, outputs.texts[i]->str());
+	}
+}
+
+static void serveConnections(int listenFd){
+	std::unique_ptr<ResidentState> resident(new ResidentState());
+	while (true){
+		int conn = accept(listenFd, nullptr, nullptr);
+		if (conn < 0){
+			if (errno == EINTR || errno == ECONNABORTED){ continue; }
+			return;
+		}
+		handleRequest(conn, resident.get());
+		close(conn);
+		if (resident->names.size() > MAX_RESIDENT_NAMES){
+			resident.reset(new ResidentState());
+		}
+	}
+}
+
+int runServer(const char * socketPath, size_t threads){
+	sockaddr_un addr;
+	if (!socketAddress(socketPath, addr)){
+		std::cerr << "Socket path too long: " << socketPath << "\n";
+		return 1;
+	}
+	//Clear out a socket left behind by an earlier server, but
+	// nothing else
+	struct stat info;
+	if (lstat(socketPath, &info) == 0 && S_ISSOCK(info.st_mode)){
+		unlink(socketPath);
+	}
+
+	int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listenFd < 0
+	  || bind(listenFd, reinterpret_cast<sockaddr *>(&addr),
+	    sizeof(addr)) != 0
+	  || listen(listenFd, SOMAXCONN) != 0){
+		std::cerr << "Could not listen on " << socketPath << ": "
+		  << strerror(errno) << "\n";
+		return 1;
+	}
+	signal(SIGPIPE, SIG_IGN);
+
+	if (threads == 0){ threads = std::thread::hardware_concurrency(); }
+	if (threads == 0){ threads = 1; }
+	std::vector<std::thread> pool;
+	for (size_t t = 1; t < threads; t++){
+		pool.emplace_back(serveConnections, listenFd);
+	}
+	serveConnections(listenFd);
+	for (std::thread& thread : pool){ thread.join(); }
+	close(listenFd);
+	return 1;
+}
+
+int runClient(const char * socketPath, const char * inPath,
+  const DriverOptions& opts){
+	std::unique_ptr<SourceBuffer> input(SourceBuffer::open(inPath));
+	if (input == nullptr){
+		std::cerr << "Bad path " << inPath << std::endl;
+		return 1;
+	}
+
+	//The cache is the client's: the server never sees it
+	std::string cacheKey;
+	if (cacheable(opts)){
+		cacheKey = OutputCache::key(input->data(), input->size(),
+		  cacheOptions(opts));
+		std::string text;
+		if (OutputCache(opts.cacheDir).lookup(cacheKey, text)){
+			if (strcmp(opts.threeACFile, "--") == 0){
+				std::cout << text << std::endl;
+				return 0;
+			}
+			std::ofstream out(opts.threeACFile);
+			if (!out.good()){
+				std::cerr << "InternalError: Bad output file "
+				  << opts.threeACFile << "\n";
+				return 1;
+			}
+			out << text << std::endl;
+			return 0;
+		}
+	}
+
+	sockaddr_un addr;
+	int fd = -1;
+	if (socketAddress(socketPath, addr)){
+		fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	}
+	if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&addr),
+	  sizeof(addr)) != 0){
+		std::cerr << "Could not connect to " << socketPath << "\n";
+		if (fd >= 0){ close(fd); }
+		return 1;
+	}
+
+	auto pathOf = [](const char * path){
+		return std::string(path == nullptr ? "" : path);
+	};
+	std::string flags;
+	if (opts.checkParse){ flags += "p"; }
+	if (opts.checkTypes){ flags += "c"; }
+	if (opts.stream){ flags += "s"; }
+	flags += opts.lexer == LexerKind::FLEX ? "f" : "h";
+	//The thread count, if any, runs to the end of the flags
+	if (opts.threads != 1){ flags += "j" + std::to_string(opts.threads); }
+	std::vector<std::string> req = {
+		PROTOCOL_VERSION, inPath,
+		std::string(input->data(), input->size()),
+		pathOf(opts.tokensFile), pathOf(opts.unparseFile),
+		pathOf(opts.nameFile), pathOf(opts.threeACFile), flags
+	};
+	bool ok = true;
+	for (const std::string& str : req){
+		ok = ok && sendString(fd, str);
+	}
+
+	std::string version, status, outText, errText, fileCount;
+	ok = ok && recvString(fd, version, MAX_FIELD_BYTES)
+	  && version == PROTOCOL_VERSION
+	  && recvString(fd, status, MAX_FIELD_BYTES)
+	  && recvString(fd, outText, UINT32_MAX)
+	  && recvString(fd, errText, UINT32_MAX)
+	  && recvString(fd, fileCount, MAX_FIELD_BYTES);
+	unsigned long exitStatus = 0;
+	unsigned long count = 0;
+	ok = ok && parseCount(status, 255, exitStatus)
+	  && parseCount(fileCount, MAX_OUTPUT_FILES, count);
+	std::vector<std::string> files;
+	for (size_t i = 0; ok && i < 2 * count; i++){
+		files.emplace_back();
+		//Each output's path, then its text
+		ok = recvString(fd, files.back(),
+		  i % 2 == 0 ? MAX_FIELD_BYTES : UINT32_MAX);
+	}
+	close(fd);
+	if (!ok){
+		std::cerr << "Bad response from " << socketPath << "\n";
+		return 1;
+	}
+
+	for (size_t i = 0; i < count; i++){
+		std::ofstream out(files[2 * i]);
+		if (!out.good()){
+			std::cerr << "InternalError: Bad output file "
+			  << files[2 * i] << "\n";
+			exitStatus = 1;
+			continue;
+		}
+		out << files[2 * i + 1];
+	}
+	std::cout << outText << std::flush;
+	std::cerr << errText << std::flush;
+
+	//Store only what a cached run could stand in for: the 3AC
+	// and nothing else
+	if (!cacheKey.empty() && exitStatus == 0 && errText.empty()){
+		bool toStdout = strcmp(opts.threeACFile, "--") == 0;
+		const std::string * text = nullptr;
+		if (toStdout && count == 0){ text = &outText; }
+		if (!toStdout && count == 1 && outText.empty()){ text = &files[1]; }
+		if (text != nullptr && !text->empty() && text->back() == '\n'){
+			OutputCache(opts.cacheDir).store(cacheKey,
+			  text->substr(0, text->size() - 1));
+		}
+	}
+	return static_cast<int>(exitStatus);
+}
+
+}
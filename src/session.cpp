@@ -0,0 +1,171 @@
+#include <memory>
+
+#include "session.hpp"
+#include "lexer.hpp"
+#include "pipelined_lexer.hpp"
+
+namespace holeyc{
+
+CompilationSession::CompilationSession(const char * inPathIn,
+  std::ostream& diagOut, std::ostream& msgOut)
+: CompilationSession(SourceBuffer::open(inPathIn), inPathIn,
+  diagOut, msgOut){
+}
+
+CompilationSession::CompilationSession(SourceBuffer * sourceIn,
+  const char * nameIn, std::ostream& diagOut, std::ostream& msgOut,
+  ResidentState * resident)
+: inPath(nameIn), source(sourceIn), ctx(diagOut, msgOut, resident),
+  tokenArena(resident ? &resident->tokenArena : &ownTokenArena),
+  astArena(resident ? &resident->astArena : &ownASTArena),
+  astBuilder(astArena){
+	if (source != nullptr){
+		srcMgr = new SourceManager(source->data(), source->size());
+		ctx.setSource(srcMgr);
+	}
+}
+
+CompilationSession::~CompilationSession(){
+	//Resident arenas outlive the session, but what it put in
+	// them doesn't
+	tokenArena->reset();
+	astArena->reset();
+	delete chunkedLexer;
+	delete myLexErrors;
+	delete tokenFile;
+	delete myIR;
+	delete myTypeAnalysis;
+	delete myNameAnalysis;
+	delete myPlan;
+	delete srcMgr;
+	delete source;
+}
+
+void CompilationSession::setTokenFile(TokenFile * fileIn){
+	delete tokenFile;
+	tokenFile = fileIn;
+}
+
+const std::vector<LexedToken> * CompilationSession::tokens(){
+	//Lexing again would report its errors a second time
+	if (lexState == RELEASED){
+		throw new InternalError("Tokens asked for after parsing");
+	}
+	if (lexState == NOT_RUN){
+		myLexErrors = new LexErrors(srcMgr);
+		lexAll(*myLexErrors);
+		myLexErrors->reportTo(ctx.diags);
+		lexState = DONE;
+	}
+	return &myTokens;
+}
+
+void CompilationSession::lexAll(LexErrors& errors){
+	if (tokenFile != nullptr){
+		tokenFile->load(&ctx, tokenArena, myTokens, errors);
+	} else if (threads != 1 && ctx.lexer == LexerKind::HAND){
+		chunkedLexer = new ChunkedLexer(&ctx, threads);
+		chunkedLexer->lexAll(myTokens, tokenArena, errors);
+	} else {
+		std::unique_ptr<Lexer> lexer(Lexer::build(&ctx, tokenArena));
+		lexer->lexAll(myTokens, errors);
+	}
+}
+
+void CompilationSession::releaseTokens(){
+	myTokens.clear();
+	myTokens.shrink_to_fit();
+	tokenArena->reset();
+	delete chunkedLexer;
+	chunkedLexer = nullptr;
+	delete myLexErrors;
+	myLexErrors = nullptr;
+	lexState = RELEASED;
+}
+
+ProgramNode * CompilationSession::ast(){
+	if (parseState == NOT_RUN){
+		int errCode;
+		//Unless the input is big enough to lex in pieces (or
+		// isn't lexed at all), with threads to spare the lexer
+		// may as well run alongside the parser
+		bool chunked = threads != 1 && ctx.lexer == LexerKind::HAND
+		  && ChunkedLexer::splits(srcMgr->size());
+		if (lexState == DONE){
+			//Its errors were all reported when it was lexed
+			TokenReplay replay(&myTokens);
+			Parser parser(replay, astBuilder, &myAST, ctx.diags);
+			errCode = parser.parse();
+		} else if (chunked || tokenFile != nullptr){
+			//Each error is held back until the parser gets to its
+			// token, as it would be lexing as the parser goes
+			LexErrors errors(srcMgr);
+			lexAll(errors);
+			TokenReplay replay(&myTokens, &errors, &ctx.diags);
+			Parser parser(replay, astBuilder, &myAST, ctx.diags);
+			errCode = parser.parse();
+		} else if (threads != 1){
+			errCode = parsePipelined();
+		} else {
+			//Lexed as the parser asks for tokens, so lexical and
+			// syntax errors come out in input order, and none are
+			// reported past the first syntax error
+			std::unique_ptr<Lexer> lexer(Lexer::build(&ctx, tokenArena));
+			Parser parser(*lexer, astBuilder, &myAST, ctx.diags);
+			errCode = parser.parse();
+		}
+		parseState = (errCode == 0) ? DONE : FAILED;
+		//The AST copies everything it needs out of the tokens
+		releaseTokens();
+	}
+	if (parseState == FAILED){ return nullptr; }
+	return myAST;
+}
+
+int CompilationSession::parsePipelined(){
+	PipelinedLexer lexer(&ctx, tokenArena);
+	Parser parser(lexer, astBuilder, &myAST, ctx.diags);
+	int errCode = parser.parse();
+	lexer.finish();
+	return errCode;
+}
+
+NameAnalysis * CompilationSession::nameAnalysis(){
+	if (nameState == NOT_RUN){
+		ProgramNode * root = ast();
+		if (root != nullptr){
+			if (fnCache != nullptr){
+				myPlan = new IncrementalPlan(root, astBuilder.idNodes(),
+				  &ctx.types, srcMgr, fnCache);
+			}
+			myNameAnalysis = NameAnalysis::build(root, &ctx, myPlan,
+			  threads);
+		}
+		nameState = myNameAnalysis ? DONE : FAILED;
+	}
+	return myNameAnalysis;
+}
+
+TypeAnalysis * CompilationSession::typeAnalysis(){
+	if (typeState == NOT_RUN){
+		NameAnalysis * na = nameAnalysis();
+		if (na != nullptr){
+			myTypeAnalysis = TypeAnalysis::build(na, threads);
+		}
+		typeState = myTypeAnalysis ? DONE : FAILED;
+	}
+	return myTypeAnalysis;
+}
+
+IRProgram * CompilationSession::ir(){
+	if (irState == NOT_RUN){
+		TypeAnalysis * ta = typeAnalysis();
+		if (ta != nullptr){
+			myIR = ta->ast->to3AC(ta, threads);
+		}
+		irState = myIR ? DONE : FAILED;
+	}
+	return myIR;
+}
+
+}
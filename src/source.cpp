@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "source.hpp"
+
+namespace holeyc{
+
+//Read everything left on the descriptor into the given string
+static bool readAll(int fd, std::string& out){
+	char chunk[65536];
+	while (true){
+		ssize_t got = read(fd, chunk, sizeof(chunk));
+		if (got == 0){ return true; }
+		if (got < 0){ return false; }
+		out.append(chunk, static_cast<size_t>(got));
+	}
+}
+
+SourceBuffer * SourceBuffer::open(const char * path){
+	int fd = ::open(path, O_RDONLY);
+	if (fd < 0){ return nullptr; }
+
+	SourceBuffer * buf = new SourceBuffer();
+	struct stat info;
+	bool canMap = fstat(fd, &info) == 0
+		&& S_ISREG(info.st_mode) && info.st_size > 0;
+	if (canMap && static_cast<uint64_t>(info.st_size) > UINT32_MAX){
+		close(fd);
+		delete buf;
+		return nullptr;
+	}
+	if (canMap){
+		size_t len = static_cast<size_t>(info.st_size);
+		void * addr = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (addr != MAP_FAILED){
+			//The scanner reads the file front to back
+			madvise(addr, len, MADV_SEQUENTIAL);
+			buf->myData = static_cast<const char *>(addr);
+			buf->mySize = len;
+			buf->mapped = true;
+			close(fd);
+			return buf;
+		}
+	}
+
+	//Not mappable: fall back to reading the stream
+	if (!readAll(fd, buf->owned) || buf->owned.size() > UINT32_MAX){
+		close(fd);
+		delete buf;
+		return nullptr;
+	}
+	close(fd);
+	buf->myData = buf->owned.data();
+	buf->mySize = buf->owned.size();
+	return buf;
+}
+
+SourceBuffer * SourceBuffer::copy(const char * data, size_t size){
+	if (size > UINT32_MAX){ return nullptr; }
+	SourceBuffer * buf = new SourceBuffer();
+	buf->owned.assign(data, size);
+	buf->myData = buf->owned.data();
+	buf->mySize = buf->owned.size();
+	return buf;
+}
+
+SourceBuffer * SourceBuffer::borrow(const char * data, size_t size){
+	if (size > UINT32_MAX){ return nullptr; }
+	SourceBuffer * buf = new SourceBuffer();
+	buf->myData = data;
+	buf->mySize = size;
+	return buf;
+}
+
+SourceBuffer::~SourceBuffer(){
+	if (mapped){
+		munmap(const_cast<char *>(myData), mySize);
+	}
+}
+
+SourceManager::SourceManager(const char * dataIn, size_t sizeIn)
+: myData(dataIn), mySize(sizeIn){
+	lineStarts.push_back(0);
+	const char * end = myData + mySize;
+	const char * nl = myData;
+	while ((nl = static_cast<const char *>(
+	  memchr(nl, '\n', static_cast<size_t>(end - nl)))) != nullptr){
+		nl++;
+		lineStarts.push_back(static_cast<SrcOffset>(nl - myData));
+	}
+}
+
+size_t SourceManager::lineIndex(SrcOffset at) const {
+	//The last line starting at or before the offset
+	auto after = std::upper_bound(lineStarts.begin(), 
+	  lineStarts.end(), at);
+	return static_cast<size_t>(after - lineStarts.begin()) - 1;
+}
+
+size_t SourceManager::line(SrcOffset at) const {
+	return lineIndex(at) + 1;
+}
+
+size_t SourceManager::col(SrcOffset at) const {
+	return at - lineStarts[lineIndex(at)] + 1;
+}
+
+std::string SourceManager::pos(SrcOffset at) const {
+	size_t index = lineIndex(at);
+	return "[" + std::to_string(index + 1) + ","
+		+ std::to_string(at - lineStarts[index] + 1) + "]";
+}
+
+}
@@ -0,0 +1,109 @@
+#include "stream.hpp"
+#include "lexer.hpp"
+#include "type_analysis.hpp"
+
+namespace holeyc{
+
+StreamCompiler::StreamCompiler(CompilationContext * ctxIn, bool lower)
+: ctx(ctxIn), builder(&astArena), nameDiags(ctxIn->source()),
+  typeDiags(ctxIn->source()), names(ctxIn, &nameDiags){
+	builder.setDeclSink(this);
+	if (lower){
+		prog = new IRProgram(nullptr);
+		spoolFile = tmpfile();
+	}
+}
+
+StreamCompiler::~StreamCompiler(){
+	delete scanner;
+	delete prog;
+	if (spoolFile != nullptr){ fclose(spoolFile); }
+}
+
+void StreamCompiler::run(){
+	scanner = Lexer::build(ctx, &tokenArenas[tokenSide]);
+	ProgramNode * root = nullptr;
+	Parser parser(*scanner, builder, &root, ctx->diags);
+	parseOK = parser.parse() == 0;
+	astArena.reset();
+	//A whole-program compilation only analyzes names once the
+	// parse is done, and types once every name resolved
+	if (parseOK){
+		ctx->diags.replay(nameDiags);
+		if (namesOK){ ctx->diags.replay(typeDiags); }
+	}
+}
+
+void StreamCompiler::topLevel(DeclNode * decl, size_t nodeCount){
+	//The parser may already hold the token after decl, which
+	// was lexed into the current arena. The other one only holds
+	// tokens up to the start of decl, all of which are done with.
+	tokenSide = 1 - tokenSide;
+	tokenArenas[tokenSide].reset();
+	scanner->setTokenArena(&tokenArenas[tokenSide]);
+
+	NameAnalysis * na = names.analyze(decl, nodeCount);
+	if (na == nullptr){ namesOK = false; }
+	//As in a whole-program compilation, types are only checked
+	// while every name so far resolved
+	if (na != nullptr && namesOK){
+		TypeAnalysis * ta = TypeAnalysis::build(na, decl, nodeCount,
+		  &typeDiags);
+		if (ta == nullptr){
+			typesOK = false;
+		} else if (prog != nullptr && typesOK && myLowerError.empty()){
+			lower(decl, ta);
+		}
+		delete ta;
+	}
+	delete na;
+	names.releaseLocals();
+}
+
+void StreamCompiler::lower(DeclNode * decl, TypeAnalysis * ta){
+	prog->setTypeAnalysis(ta);
+	try {
+		decl->to3AC(prog);
+	} catch (ToDoError * e){
+		myLowerError = "ToDoError: " + std::string(e->msg());
+	} catch (InternalError * e){
+		myLowerError = "InternalError: " + std::string(e->msg());
+	}
+	prog->setTypeAnalysis(nullptr);
+
+	std::string text;
+	Emitter out(text);
+	prog->flushProcs(out);
+	spool(text);
+}
+
+void StreamCompiler::spool(const std::string& text){
+	if (spoolFile == nullptr){
+		spoolText += text;
+	} else if (fwrite(text.data(), 1, text.size(), spoolFile)
+	  != text.size()){
+		throw new InternalError("Could not spool the 3AC");
+	}
+}
+
+void StreamCompiler::write3AC(std::ostream& out){
+	if (prog == nullptr){
+		throw new InternalError("3AC not generated");
+	}
+	{
+		Emitter globals(out);
+		prog->emitGlobals(globals);
+	}
+	if (spoolFile != nullptr){
+		fflush(spoolFile);
+		rewind(spoolFile);
+		char buf[64 * 1024];
+		size_t got;
+		while ((got = fread(buf, 1, sizeof(buf), spoolFile)) > 0){
+			out.write(buf, static_cast<std::streamsize>(got));
+		}
+	}
+	out << spoolText << std::endl;
+}
+
+}
@@ -3,88 +3,82 @@
 #include "types.hpp"
 namespace holeyc{
 
-SymbolTable::SymbolTable(){
-	scopeTableChain = new std::list<ScopeTable *>();
+const uint32_t SymbolTable::NO_BINDING;
+
+SymbolTable::SymbolTable(TypeContext * typesIn)
+: myTypes(typesIn){
 }
 
-void SymbolTable::print(){
-	for(auto scope : *scopeTableChain){
-		std::cout << "--- scope ---\n";
-		std::cout << scope->toString();
+void SymbolTable::print(std::ostream& out) const {
+	uint32_t scope = 0;
+	for (uint32_t i = 0; i < bindings.size(); i++){
+		while (scope < scopeMarks.size() && scopeMarks[scope] <= i){
+			out << "--- scope ---\n";
+			scope++;
+		}
+		out << bindings[i].symbol->toString() << "\n";
 	}
 }
 
-ScopeTable * SymbolTable::enterScope(){
-	ScopeTable * newScope = new ScopeTable();
-	scopeTableChain->push_front(newScope);
-	return newScope;
+void SymbolTable::enterScope(){
+	scopeMarks.push_back(static_cast<uint32_t>(bindings.size()));
 }
 
 void SymbolTable::leaveScope(){
-	if (scopeTableChain->empty()){
+	if (scopeMarks.empty()){
 		throw new InternalError("Attempt to pop"
 			"empty symbol table");
 	}
-	scopeTableChain->pop_front();
-}
-
-ScopeTable * SymbolTable::getCurrentScope(){
-	return scopeTableChain->front();
-}
-
-bool SymbolTable::clash(std::string varName){
-	bool hasClash = getCurrentScope()->clash(varName);
-	return hasClash;
-}
-
-SemSymbol * SymbolTable::find(std::string varName){
-	for (ScopeTable * scope : *scopeTableChain){
-		SemSymbol * sym = scope->lookup(varName);
-		if (sym != nullptr) { return sym; }
+	uint32_t mark = scopeMarks.back();
+	scopeMarks.pop_back();
+	while (bindings.size() > mark){
+		const Binding& undone = bindings.back();
+		heads[undone.name] = undone.shadowed;
+		bindings.pop_back();
 	}
-	return nullptr;
 }
 
-bool SymbolTable::insert(SemSymbol * symbol){
-	return scopeTableChain->front()->insert(symbol);
-}
-
-ScopeTable::ScopeTable(){
-	symbols = new HashMap<std::string, SemSymbol *>();
-}
-
-std::string ScopeTable::toString(){
-	std::string result = "";
-	for (auto entry : *symbols){
-		result += entry.second->toString();
-		result += "\n";
+uint32_t SymbolTable::innermost(Ident name) const{
+	if (name.id() >= heads.size()){
+		return NO_BINDING;
 	}
-	return result;
+	return heads[name.id()];
 }
 
-bool ScopeTable::clash(std::string varName){
-	SemSymbol * found = lookup(varName);
-	if (found != nullptr){
-		return true;
+bool SymbolTable::clash(Ident varName) const{
+	uint32_t found = innermost(varName);
+	if (found == NO_BINDING){
+		return false;
 	}
-	return false;
+	return bindings[found].depth == depth();
 }
 
-SemSymbol * ScopeTable::lookup(std::string name){
-	auto found = symbols->find(name);
-	if (found == symbols->end()){
-		return NULL;
+SemSymbol * SymbolTable::find(Ident varName) const{
+	uint32_t found = innermost(varName);
+	if (found == NO_BINDING){
+		return nullptr;
 	}
-	return found->second;
+	return bindings[found].symbol;
 }
 
-bool ScopeTable::insert(SemSymbol * symbol){
-	std::string symName = symbol->getName();
-	bool alreadyInScope = (this->lookup(symName) != NULL);
-	if (alreadyInScope){
+bool SymbolTable::insert(SemSymbol * symbol){
+	if (scopeMarks.empty()){
+		throw new InternalError("Insert outside of any scope");
+	}
+	Ident symName = symbol->getIdent();
+	if (clash(symName)){
 		return false;
 	}
-	this->symbols->insert(std::make_pair(symName, symbol));
+	if (symName.id() >= heads.size()){
+		heads.resize(symName.id() + 1, NO_BINDING);
+	}
+	Binding binding;
+	binding.symbol = symbol;
+	binding.name = symName.id();
+	binding.depth = static_cast<uint32_t>(depth());
+	binding.shadowed = heads[symName.id()];
+	heads[symName.id()] = static_cast<uint32_t>(bindings.size());
+	bindings.push_back(binding);
 	return true;
 }
 
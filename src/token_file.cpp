@@ -0,0 +1,273 @@
+#include <cstring>
+#include <unordered_map>
+
+#include "token_file.hpp"
+#include "cache.hpp"
+
+namespace holeyc{
+
+using TokenKind = holeyc::Parser::token;
+
+static const char MAGIC[8] = {'H', 'C', 'T', 'O', 'K', 'E', 'N', 'S'};
+static const size_t KEY_SIZE = 32;
+static const uint32_t NO_STRING = UINT32_MAX;
+
+struct TokenFile::Header{
+	char magic[8];
+	char key[KEY_SIZE];
+	uint32_t sourceSize;
+	uint32_t tokens;
+	uint32_t diags;
+	uint32_t strings;
+	uint32_t stringBytes;
+};
+
+struct TokenFile::TokenRecord{
+	uint32_t kind;
+	uint32_t offset;
+	uint32_t payload;
+};
+
+struct TokenFile::DiagRecord{
+	uint32_t token;
+	uint32_t severity;
+	uint32_t line;
+	uint32_t col;
+	uint32_t message;
+};
+
+//The string table as it is built up, each text added once
+class StringTable{
+public:
+	uint32_t add(const char * text, size_t len){
+		auto found = indices.emplace(std::string(text, len),
+		  static_cast<uint32_t>(starts.size()));
+		if (found.second){
+			starts.push_back(static_cast<uint32_t>(bytes.size()));
+			bytes.append(text, len);
+		}
+		return found.first->second;
+	}
+	uint32_t add(const std::string& text){
+		return add(text.data(), text.size());
+	}
+	uint32_t add(TextView text){
+		return add(text.data(), text.size());
+	}
+	//A name is looked up by its ID after the first time
+	uint32_t add(Ident name){
+		if (byName.size() <= name.id()){
+			byName.resize(name.id() + 1, NO_STRING);
+		}
+		if (byName[name.id()] == NO_STRING){
+			byName[name.id()] = add(name.text());
+		}
+		return byName[name.id()];
+	}
+
+	std::vector<uint32_t> starts;
+	std::string bytes;
+private:
+	std::unordered_map<std::string, uint32_t> indices;
+	std::vector<uint32_t> byName;
+};
+
+template <typename T>
+static void writeAll(std::ostream& out, const std::vector<T>& items){
+	out.write(reinterpret_cast<const char *>(items.data()),
+	  static_cast<std::streamsize>(items.size() * sizeof(T)));
+}
+
+void TokenFile::write(const std::vector<LexedToken>& tokens,
+  const LexErrors& lexErrors, const SourceManager& src,
+  std::ostream& out){
+	StringTable table;
+	std::vector<TokenRecord> tokenRecs;
+	tokenRecs.reserve(tokens.size());
+	for (const LexedToken& tok : tokens){
+		uint32_t payload = 0;
+		switch (tok.kind){
+		case TokenKind::ID:
+			payload = table.add(static_cast<IDToken *>(tok.token)->value());
+			break;
+		case TokenKind::STRLITERAL:
+			payload = table.add(static_cast<StrToken *>(tok.token)->str());
+			break;
+		case TokenKind::INTLITERAL:
+			payload = static_cast<uint32_t>(
+			  static_cast<IntLitToken *>(tok.token)->num());
+			break;
+		case TokenKind::CHARLIT:
+			payload = static_cast<unsigned char>(
+			  static_cast<CharLitToken *>(tok.token)->val());
+			break;
+		}
+		tokenRecs.push_back(TokenRecord{static_cast<uint32_t>(tok.kind),
+		  tok.token->offset(), payload});
+	}
+	std::vector<DiagRecord> diagRecs;
+	for (size_t i = 0; i < lexErrors.size(); i++){
+		const Diagnostic& diag = lexErrors.at(i);
+		diagRecs.push_back(DiagRecord{
+		  static_cast<uint32_t>(lexErrors.tokenAt(i)),
+		  static_cast<uint32_t>(diag.severity),
+		  static_cast<uint32_t>(diag.line), static_cast<uint32_t>(diag.col),
+		  table.add(diag.message)});
+	}
+	uint32_t stringCount = static_cast<uint32_t>(table.starts.size());
+	table.starts.push_back(static_cast<uint32_t>(table.bytes.size()));
+
+	Header header;
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	std::string key = OutputCache::key(src.data(), src.size(), TOKEN_FORMAT);
+	memcpy(header.key, key.data(), KEY_SIZE);
+	header.sourceSize = static_cast<uint32_t>(src.size());
+	header.tokens = static_cast<uint32_t>(tokenRecs.size());
+	header.diags = static_cast<uint32_t>(diagRecs.size());
+	header.strings = stringCount;
+	header.stringBytes = static_cast<uint32_t>(table.bytes.size());
+	out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	writeAll(out, tokenRecs);
+	writeAll(out, diagRecs);
+	writeAll(out, table.starts);
+	out.write(table.bytes.data(),
+	  static_cast<std::streamsize>(table.bytes.size()));
+}
+
+TokenFile * TokenFile::open(const char * path){
+	SourceBuffer * buf = SourceBuffer::open(path);
+	if (buf == nullptr){ return nullptr; }
+	TokenFile * file = new TokenFile(buf);
+	if (!file->validate()){
+		delete file;
+		return nullptr;
+	}
+	return file;
+}
+
+TokenFile::~TokenFile(){
+	delete buf;
+}
+
+//Check everything load() relies on up front, so that a
+// truncated or garbled file is turned away rather than read
+// out of bounds
+bool TokenFile::validate(){
+	if (buf->size() < sizeof(Header)){ return false; }
+	Header header;
+	memcpy(&header, buf->data(), sizeof(header));
+	if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0){ return false; }
+	key.assign(header.key, KEY_SIZE);
+	sourceSize = header.sourceSize;
+	tokenCount = header.tokens;
+	diagCount = header.diags;
+	stringCount = header.strings;
+
+	tokensAt = sizeof(Header);
+	diagsAt = tokensAt + tokenCount * sizeof(TokenRecord);
+	startsAt = diagsAt + diagCount * sizeof(DiagRecord);
+	bytesAt = startsAt + (stringCount + 1) * sizeof(uint32_t);
+	if (bytesAt + header.stringBytes != buf->size()){ return false; }
+
+	if (stringStart(0) != 0){ return false; }
+	for (size_t i = 1; i <= stringCount; i++){
+		if (stringStart(i) < stringStart(i - 1)){ return false; }
+	}
+	if (stringStart(stringCount) != header.stringBytes){ return false; }
+
+	if (tokenCount == 0){ return false; }
+	for (size_t i = 0; i < tokenCount; i++){
+		TokenRecord rec = token(i);
+		int kind = static_cast<int>(rec.kind);
+		if (rec.offset > sourceSize){ return false; }
+		bool hasText = kind == TokenKind::ID || kind == TokenKind::STRLITERAL;
+		if (hasText && rec.payload >= stringCount){ return false; }
+	}
+	if (token(tokenCount - 1).kind != TokenKind::END){ return false; }
+	for (size_t i = 0; i < diagCount; i++){
+		DiagRecord rec = diag(i);
+		if (rec.message >= stringCount){ return false; }
+		if (rec.token >= tokenCount){ return false; }
+		if (i > 0 && rec.token < diag(i - 1).token){ return false; }
+		if (rec.severity != Diagnostic::FATAL
+		  && rec.severity != Diagnostic::WARNING){ return false; }
+	}
+	return true;
+}
+
+bool TokenFile::matches(const SourceManager& src) const {
+	return sourceSize == src.size()
+	  && key == OutputCache::key(src.data(), src.size(), TOKEN_FORMAT);
+}
+
+TokenFile::TokenRecord TokenFile::token(size_t index) const {
+	TokenRecord rec;
+	memcpy(&rec, buf->data() + tokensAt + index * sizeof(rec), sizeof(rec));
+	return rec;
+}
+
+TokenFile::DiagRecord TokenFile::diag(size_t index) const {
+	DiagRecord rec;
+	memcpy(&rec, buf->data() + diagsAt + index * sizeof(rec), sizeof(rec));
+	return rec;
+}
+
+uint32_t TokenFile::stringStart(size_t index) const {
+	uint32_t start;
+	memcpy(&start, buf->data() + startsAt + index * sizeof(start),
+	  sizeof(start));
+	return start;
+}
+
+const char * TokenFile::stringText(uint32_t index, size_t& len) const {
+	uint32_t start = stringStart(index);
+	len = stringStart(index + 1) - start;
+	return buf->data() + bytesAt + start;
+}
+
+void TokenFile::load(CompilationContext * ctx, Arena * tokenArena,
+  std::vector<LexedToken>& tokens, LexErrors& errors) const {
+	size_t len;
+	size_t base = tokens.size();
+	for (size_t i = 0; i < diagCount; i++){
+		DiagRecord rec = diag(i);
+		const char * text = stringText(rec.message, len);
+		errors.add(base + rec.token, Diagnostic{
+		  static_cast<Diagnostic::Severity>(rec.severity),
+		  rec.line, rec.col, std::string(text, len)});
+	}
+
+	tokens.reserve(tokens.size() + tokenCount);
+	for (size_t i = 0; i < tokenCount; i++){
+		TokenRecord rec = token(i);
+		int kind = static_cast<int>(rec.kind);
+		Token * tok;
+		switch (kind){
+		case TokenKind::ID: {
+			const char * text = stringText(rec.payload, len);
+			tok = tokenArena->make<IDToken>(rec.offset,
+			  ctx->names.intern(text, len));
+			break;
+		}
+		case TokenKind::STRLITERAL: {
+			const char * text = stringText(rec.payload, len);
+			tok = tokenArena->make<StrToken>(rec.offset,
+			  TextView(text, len));
+			break;
+		}
+		case TokenKind::INTLITERAL:
+			tok = tokenArena->make<IntLitToken>(rec.offset,
+			  static_cast<int>(rec.payload));
+			break;
+		case TokenKind::CHARLIT:
+			tok = tokenArena->make<CharLitToken>(rec.offset,
+			  static_cast<char>(rec.payload));
+			break;
+		default:
+			tok = tokenArena->make<Token>(rec.offset, kind);
+		}
+		tokens.push_back(LexedToken{kind, tok});
+	}
+}
+
+}
@@ -60,63 +60,56 @@ static std::string tokenKindString(int tokKind){
 	
 }
 
-Token::Token(size_t lineIn, size_t columnIn, int kindIn)
-  : myLine(lineIn), myCol(columnIn), myKind(kindIn){
+Token::Token(SrcOffset offsetIn, int kindIn)
+  : myOffset(offsetIn), myKind(kindIn){
 }
 
-std::string Token::toString(){
+std::string Token::toString(const SourceManager& src){
 	return tokenKindString(kind())
-	+ " [" + std::to_string(line()) 
-	+ "," + std::to_string(col()) + "]";
+	+ " " + src.pos(offset());
 }
 
-size_t Token::line() const { 
-	return this->myLine; 
-}
-
-size_t Token::col() const { 
-	return this->myCol; 
+SrcOffset Token::offset() const { 
+	return this->myOffset; 
 }
 
 int Token::kind() const { 
 	return this->myKind; 
 }
 
-IDToken::IDToken(size_t lIn, size_t cIn, std::string vIn)
-  : Token(lIn, cIn, TokenKind::ID), myValue(vIn){ 
+IDToken::IDToken(SrcOffset offsetIn, Ident vIn)
+  : Token(offsetIn, TokenKind::ID), myValue(vIn){ 
 }
 
-std::string IDToken::toString(){
+std::string IDToken::toString(const SourceManager& src){
 	return tokenKindString(kind()) + ":"
-	+ this->myValue
-	+ " [" + std::to_string(line()) 
-	+ "," + std::to_string(col()) + "]";
+	+ this->myValue.text()
+	+ " " + src.pos(offset());
 }
 
-const std::string IDToken::value() const { 
+Ident IDToken::value() const { 
 	return this->myValue; 
 }
 
-StrToken::StrToken(size_t lIn, size_t cIn, std::string sIn)
-  : Token(lIn, cIn, TokenKind::STRLITERAL), myStr(sIn){
+StrToken::StrToken(SrcOffset offsetIn, TextView sIn)
+  : Token(offsetIn, TokenKind::STRLITERAL), myStr(sIn){
 }
 
-std::string StrToken::toString(){
+std::string StrToken::toString(const SourceManager& src){
 	return tokenKindString(kind()) + ":"
-	+ this->myStr
-	+ " [" + std::to_string(line()) 
-	+ "," + std::to_string(col()) + "]";
+	+ this->myStr.str()
+	+ " " + src.pos(offset());
 }
 
-const std::string StrToken::str() const {
+TextView StrToken::str() const {
 	return this->myStr;
 }
 
-CharLitToken::CharLitToken(size_t lIn, size_t cIn, char valIn)
-  : Token(lIn, cIn, TokenKind::CHARLIT), myVal(valIn){
+CharLitToken::CharLitToken(SrcOffset offsetIn, char valIn)
+  : Token(offsetIn, TokenKind::CHARLIT), myVal(valIn){
 }
 
-std::string CharLitToken::toString() {
+std::string CharLitToken::toString(const SourceManager& src) {
 	std::string res = tokenKindString(kind()) + ":";
 
 	char v = this->val();
@@ -131,14 +124,13 @@ char CharLitToken::val() const {
 	return this->myVal;
 }
 
-IntLitToken::IntLitToken(size_t lIn, size_t cIn, int numIn)
-  : Token(lIn, cIn, TokenKind::INTLITERAL), myNum(numIn){}
+IntLitToken::IntLitToken(SrcOffset offsetIn, int numIn)
+  : Token(offsetIn, TokenKind::INTLITERAL), myNum(numIn){}
 
-std::string IntLitToken::toString(){
+std::string IntLitToken::toString(const SourceManager& src){
 	return tokenKindString(kind()) + ":"
 	+ std::to_string(this->myNum)
-	+ " [" + std::to_string(line()) 
-	+ "," + std::to_string(col()) + "]";
+	+ " " + src.pos(offset());
 }
 
 int IntLitToken::num() const {
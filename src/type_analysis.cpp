@@ -1,16 +1,31 @@
 #include <assert.h>
+#include <exception>
+#include <memory>
 
 #include "name_analysis.hpp"
 #include "type_analysis.hpp"
+#include "incremental.hpp"
+#include "parallel.hpp"
 
 namespace holeyc {
 
-TypeAnalysis * TypeAnalysis::build(NameAnalysis * nameAnalysis){
-	TypeAnalysis * typeAnalysis = new TypeAnalysis();
+TypeAnalysis * TypeAnalysis::build(NameAnalysis * nameAnalysis,
+  size_t threads){
 	auto ast = nameAnalysis->ast;	
+	TypeAnalysis * typeAnalysis = new TypeAnalysis(nameAnalysis->context,
+		&nameAnalysis->symbols, ast->nodeCount(), nameAnalysis->plan);
 	typeAnalysis->ast = ast;
 
-	ast->typeAnalysis(typeAnalysis);
+	if (threads == 1){
+		ast->typeAnalysis(typeAnalysis);
+	} else {
+		try {
+			typeAnalysis->analyzeParallel(threads);
+		} catch (...){
+			delete typeAnalysis;
+			throw;
+		}
+	}
 	if (typeAnalysis->hasError){
 		return nullptr;
 	}
@@ -19,15 +34,64 @@ TypeAnalysis * TypeAnalysis::build(NameAnalysis * nameAnalysis){
 
 }
 
+//As ProgramNode::typeAnalysis, but with each declaration
+// checked by a worker of its own
+bool TypeAnalysis::analyzeParallel(size_t threads){
+	std::vector<DeclNode *> decls(ast->getGlobals()->begin(),
+	  ast->getGlobals()->end());
+	std::vector<std::unique_ptr<Diagnostics>> diags(decls.size());
+	std::vector<char> failed(decls.size(), 0);
+	std::vector<std::exception_ptr> thrown(decls.size());
+	parallelFor(decls.size(), threads, [&](size_t i){
+		diags[i].reset(new Diagnostics(myDiags->sourceManager()));
+		TypeAnalysis worker(this, diags[i].get());
+		try {
+			decls[i]->typeAnalysis(&worker);
+		} catch (...){
+			thrown[i] = std::current_exception();
+		}
+		failed[i] = worker.hasError;
+	});
+
+	//A serial run would have stopped at the first throw
+	for (size_t i = 0; i < decls.size(); i++){
+		myDiags->replay(*diags[i]);
+		if (thrown[i]){ std::rethrow_exception(thrown[i]); }
+		hasError = hasError || failed[i];
+	}
+	nodeType(ast, types()->VOID());
+	return !hasError;
+}
+
+TypeAnalysis * TypeAnalysis::build(NameAnalysis * nameAnalysis,
+  DeclNode * decl, size_t nodeCount, Diagnostics * diags){
+	TypeAnalysis * typeAnalysis = new TypeAnalysis(nameAnalysis->context,
+		&nameAnalysis->symbols, nodeCount, nullptr);
+	typeAnalysis->ast = nullptr;
+	typeAnalysis->myDiags = diags;
+
+	decl->typeAnalysis(typeAnalysis);
+	if (typeAnalysis->hasError){
+		delete typeAnalysis;
+		return nullptr;
+	}
+	return typeAnalysis;
+}
+
+const ProcTemplate * TypeAnalysis::reusedProc(const ASTNode * fn) const {
+	if (myPlan == nullptr){ return nullptr; }
+	return myPlan->reused(fn->nodeID());
+}
+
 void ProgramNode::typeAnalysis(TypeAnalysis * typing){
 	for (auto decl : *myGlobals){
 		decl->typeAnalysis(typing);
 	}
-	typing->nodeType(this, BasicType::VOID());
+	typing->nodeType(this, typing->types()->VOID());
 }
 
 void IDNode::typeAnalysis(TypeAnalysis * typing){
-	typing->nodeType(this, mySymbol->getDataType());
+	typing->nodeType(this, typing->symbolOf(this)->getDataType());
 }
 
 void VarDeclNode::typeAnalysis(TypeAnalysis * typing){
@@ -40,17 +104,15 @@ void VarDeclNode::typeAnalysis(TypeAnalysis * typing){
 
 void FnDeclNode::typeAnalysis(TypeAnalysis * typing){
 	myRetType->typeAnalysis(typing);
-	const DataType * retDataType = typing->nodeType(myRetType);
-
-	std::list<const DataType *> * formalTypes = 
-		new std::list<const DataType *>();
 	for (auto formal : *myFormals){
 		formal->typeAnalysis(typing);
-		formalTypes->push_back(typing->nodeType(formal));
 	}	
 
-	
-	typing->nodeType(this, new FnType(formalTypes, retDataType));
+	//Name analysis made the signature's type when it bound the
+	// function, so there is nothing to look up in the context
+	typing->nodeType(this, typing->symbolOf(myID)->getDataType());
+	//A reused function's body was checked when it was cached
+	if (typing->reusedProc(this) != nullptr){ return; }
 
 	typing->setCurrentFnType(typing->nodeType(this)->asFn());
 	for (auto stmt : *myBody){
@@ -69,7 +131,7 @@ static const DataType * typeAssignOpd(TypeAnalysis * typing, ExpNode * opd){
 	//Valid types are returned
 	if (type->asBasic()){ 
 		if (type->isVoid()){
-			typing->badAssignOpd(opd->line(),opd->col());
+			typing->badAssignOpd(opd->offset());
 			return nullptr;
 		}
 		return type; 
@@ -81,7 +143,7 @@ static const DataType * typeAssignOpd(TypeAnalysis * typing, ExpNode * opd){
 	}
 
 	//Invalid types are reported and skip operator check
-	typing->badAssignOpd(opd->line(),opd->col());
+	typing->badAssignOpd(opd->offset());
 	return nullptr;
 }
 
@@ -90,7 +152,7 @@ void AssignExpNode::typeAnalysis(TypeAnalysis * typing){
 	const DataType * srcType = typeAssignOpd(typing, mySrc);
 
 	if (!dstType || !srcType){
-		typing->nodeType(this, ErrorType::produce());
+		typing->nodeType(this, typing->types()->error());
 		return;
 	}
 
@@ -102,52 +164,45 @@ void AssignExpNode::typeAnalysis(TypeAnalysis * typing){
 	//Allow any ptr type to recieve a nullptr
 	if (dstType->asPtr()){
 		if (const PtrType * srcPtr = srcType->asPtr()){
-			if (srcPtr->decLevel() == BasicType::VOID()){
+			if (srcPtr->decLevel() == typing->types()->VOID()){
 				typing->nodeType(this, dstType);
 				return;
 			}
 		}
 	}
 
-	typing->badAssignOpr(line(), col());
-	typing->nodeType(this, ErrorType::produce());
+	typing->badAssignOpr(offset());
+	typing->nodeType(this, typing->types()->error());
 	return;
 }
 
 void CallExpNode::typeAnalysis(TypeAnalysis * typing){
 
-	std::list<const DataType *> * aList = new std::list<const DataType *>();
 	for (auto actual : *myArgs){
 		actual->typeAnalysis(typing);
-		aList->push_back(typing->nodeType(actual));
 	}
 
-	SemSymbol * calleeSym = myID->getSymbol();
+	SemSymbol * calleeSym = typing->symbolOf(myID);
 	assert(calleeSym != nullptr);
 	const DataType * calleeType = calleeSym->getDataType();
 	const FnType * fnType = calleeType->asFn();
 	if (fnType == nullptr){
-		typing->badCallee(myID->line(), myID->col());
-		typing->nodeType(this, ErrorType::produce());
+		typing->badCallee(myID->offset());
+		typing->nodeType(this, typing->types()->error());
 		return;
 	}
 
-	const std::list<const DataType *>* fList = fnType->getFormalTypes();
-	if (aList->size() != fList->size()){
-		typing->badArgCount(line(), col());
+	const std::vector<const DataType *>& fList = fnType->getFormalTypes();
+	if (myArgs->size() != fList.size()){
+		typing->badArgCount(offset());
 		//Note: we still consider the call to return the 
 		// return type
 	} else {
-		auto actualTypesItr = aList->begin();
-		auto formalTypesItr = fList->begin();
-		auto actualsItr = myArgs->begin();
-		while(actualTypesItr != aList->end()){
-			const DataType * actualType = *actualTypesItr;
+		auto formalTypesItr = fList.begin();
+		for (const ExpNode * actual : *myArgs){
+			const DataType * actualType = typing->nodeType(actual);
 			const DataType * formalType = *formalTypesItr;
-			const ExpNode * actual = *actualsItr;
-			actualTypesItr++;
 			formalTypesItr++;
-			actualsItr++;
 
 			//Matching to error is ignored
 			if (actualType->asError()){ continue; }
@@ -157,8 +212,8 @@ void CallExpNode::typeAnalysis(TypeAnalysis * typing){
 			if (formalType == actualType){ continue; }
 
 			//Bad match
-			typing->badArgMatch(actual->line(), actual->col());
-			typing->nodeType(this, ErrorType::produce());
+			typing->badArgMatch(actual->offset());
+			typing->nodeType(this, typing->types()->error());
 		}
 	}
 
@@ -176,10 +231,10 @@ void NegNode::typeAnalysis(TypeAnalysis * typing){
 		return;
 	}
 	if (subType->isInt()){
-		typing->nodeType(this, BasicType::INT());
+		typing->nodeType(this, typing->types()->INT());
 	} else {
-		typing->badMathOpd(myExp->line(), myExp->col());
-		typing->nodeType(this, ErrorType::produce());
+		typing->badMathOpd(myExp->offset());
+		typing->nodeType(this, typing->types()->error());
 	}
 }
 
@@ -189,47 +244,29 @@ void NotNode::typeAnalysis(TypeAnalysis * typing){
 	if (childType->isBool()){
 		typing->nodeType(this, childType);
 	} else if (childType->asError() != nullptr){
-		typing->nodeType(this, ErrorType::produce());
+		typing->nodeType(this, typing->types()->error());
 		return;
 	} else {
-		typing->badLogicOpd(myExp->line(), myExp->col());
-		typing->nodeType(this, ErrorType::produce());
+		typing->badLogicOpd(myExp->offset());
+		typing->nodeType(this, typing->types()->error());
 	}
 }
 
 void VoidTypeNode::typeAnalysis(TypeAnalysis * typing){
-	typing->nodeType(this, BasicType::VOID());
+	typing->nodeType(this, typing->types()->VOID());
 }
 
 void IntTypeNode::typeAnalysis(TypeAnalysis * typing){
-	BasicType * basic = BasicType::INT();
-	if (isPtr){
-		PtrType * ptr = PtrType::produce(basic, 1);
-		typing->nodeType(this, ptr);
-	} else {
-		typing->nodeType(this, basic);
-	}
+	typing->nodeType(this, getType(typing->types()));
 }
 
 void CharTypeNode::typeAnalysis(TypeAnalysis * typing){
-	BasicType * basic = BasicType::produce(CHAR);
-	if (isPtr){
-		PtrType * ptr = PtrType::produce(basic, 1);
-		typing->nodeType(this, ptr);
-	} else {
-		typing->nodeType(this, basic);
-	}
+	typing->nodeType(this, getType(typing->types()));
 }
 
 
 void BoolTypeNode::typeAnalysis(TypeAnalysis * ta){
-	BasicType * basic = BasicType::BOOL();
-	if (isPtr){
-		PtrType * ptr = PtrType::produce(basic, 1);
-		ta->nodeType(this, ptr);
-	} else {
-		ta->nodeType(this, basic);
-	}
+	ta->nodeType(this, getType(ta->types()));
 }
 
 static bool typeMathOpd(TypeAnalysis * typing, ExpNode * opd){
@@ -242,7 +279,7 @@ static bool typeMathOpd(TypeAnalysis * typing, ExpNode * opd){
 		return false;
 	}
 
-	typing->badMathOpd(opd->line(), opd->col());
+	typing->badMathOpd(opd->offset());
 	return false;
 }
 
@@ -254,26 +291,26 @@ void IndexNode::typeAnalysis(TypeAnalysis * typing){
 	const DataType * offType = typing->nodeType(myOffset);
 
 	if (offType->asError() || baseType->asError()){
-		typing->nodeType(this, ErrorType::produce());
+		typing->nodeType(this, typing->types()->error());
 		return;
 	}
 
 	if (!offType->isInt()){
-		typing->nodeType(this, ErrorType::produce());
-		typing->badIndex(myOffset->line(), myOffset->col());
+		typing->nodeType(this, typing->types()->error());
+		typing->badIndex(myOffset->offset());
 	}
 
 	if (const PtrType * asPtr = baseType->asPtr()){
 		typing->nodeType(this, asPtr->decLevel());
 	} else {
-		typing->badPtrBase(myBase->line(), myBase->col());
+		typing->badPtrBase(myBase->offset());
 	}
 }
 
 void RefNode::typeAnalysis(TypeAnalysis * typeAnalysis){
 	myID->typeAnalysis(typeAnalysis);
 	const DataType * baseType = typeAnalysis->nodeType(myID);
-	const DataType * errType = ErrorType::produce();
+	const DataType * errType = typeAnalysis->types()->error();
 
 	if (baseType->asError()){
 		typeAnalysis->nodeType(this, errType);
@@ -282,30 +319,24 @@ void RefNode::typeAnalysis(TypeAnalysis * typeAnalysis){
 
 	if (baseType->asPtr()){
 		typeAnalysis->nodeType(this, errType);
-		auto line = myID->line();
-		auto col = myID->col();
-		typeAnalysis->badRefOpd(line, col);
+		typeAnalysis->badRefOpd(myID->offset());
 		return;
 	}
 
 	if (const DataType * asBasic = baseType->asBasic()){
 		/* Syntactically disallowed to have ref return
 		if (asBasic->isVoid()){
-			auto line = myID->line();
-			auto col = myID->col();
-			typeAnalysis->badRefOpd(line, col);
+			typeAnalysis->badRefOpd(myID->offset());
 		}
 		*/
-		const DataType * refType = PtrType::refType(baseType);
+		const DataType * refType = PtrType::refType(typeAnalysis->types(), baseType);
 		typeAnalysis->nodeType(this, refType);
 		return;
 	}
 
 	if (baseType->asFn()){
 		typeAnalysis->nodeType(this, errType);
-		auto line = myID->line();
-		auto col = myID->col();
-		typeAnalysis->badRefOpd(line, col);
+		typeAnalysis->badRefOpd(myID->offset());
 	}
 }
 
@@ -314,11 +345,11 @@ void DerefNode::typeAnalysis(TypeAnalysis * typeAnalysis){
 	const DataType * baseType = typeAnalysis->nodeType(myID);
 
 	if (baseType->asError()){
-		baseType = ErrorType::produce();
+		baseType = typeAnalysis->types()->error();
 	}
 	if (baseType->asFn()){
-		typeAnalysis->fnDeref(this->line(), this->col());
-		baseType = ErrorType::produce();
+		typeAnalysis->fnDeref(this->offset());
+		baseType = typeAnalysis->types()->error();
 	}
 	typeAnalysis->nodeType(this, PtrType::derefType(baseType));
 }
@@ -329,7 +360,7 @@ void BinaryExpNode::binaryMathTyping(
 	bool lhsValid = typeMathOpd(typing, myExp1);
 	bool rhsValid = typeMathOpd(typing, myExp2);
 	if (!lhsValid || !rhsValid){
-		typing->nodeType(this, ErrorType::produce());
+		typing->nodeType(this, typing->types()->error());
 		return;
 	}
 
@@ -338,11 +369,11 @@ void BinaryExpNode::binaryMathTyping(
 	const DataType * rhsType = typing->nodeType(myExp2);
 
 	if (lhsType->isInt() && rhsType->isInt()){
-		typing->nodeType(this, BasicType::INT());
+		typing->nodeType(this, typing->types()->INT());
 		return;
 	}
-	typing->badMathOpr(this->line(), this->col());
-	typing->nodeType(this, ErrorType::produce());
+	typing->badMathOpr(this->offset());
+	typing->nodeType(this, typing->types()->error());
 	return;
 }
 
@@ -361,7 +392,7 @@ static const DataType * typeLogicOpd(
 
 	//If type isn't an error, but is incompatible,
 	// report and indicate incompatibility
-	typing->badLogicOpd(opd->line(), opd->col());
+	typing->badLogicOpd(opd->offset());
 	return NULL;
 }
 
@@ -369,20 +400,20 @@ void BinaryExpNode::binaryLogicTyping(TypeAnalysis * typing){
 	const DataType * lhsType = typeLogicOpd(typing, myExp1);
 	const DataType * rhsType = typeLogicOpd(typing, myExp2);
 	if (!lhsType || !rhsType){
-		typing->nodeType(this, ErrorType::produce());
+		typing->nodeType(this, typing->types()->error());
 		return;
 	}
 
 	//Given valid operand types, check operator
 	if (lhsType->isBool() && rhsType->isBool()){
-		typing->nodeType(this, BasicType::BOOL());
+		typing->nodeType(this, typing->types()->BOOL());
 		return;
 	}
 
 	//We never expect to get here, so we'll consider it
 	// an error with the compiler itself
 	throw new InternalError("Incomplete typing");
-	typing->nodeType(this, ErrorType::produce());
+	typing->nodeType(this, typing->types()->error());
 	return;
 }
 
@@ -427,7 +458,7 @@ static const DataType * typeEqOpd(
 	//Errors are invalid, but don't cause re-reports
 	if (type->asError()){ return nullptr; }
 
-	typing->badEqOpd(opd->line(), opd->col());
+	typing->badEqOpd(opd->offset());
 	return nullptr;
 }
 
@@ -436,24 +467,24 @@ void BinaryExpNode::binaryEqTyping(TypeAnalysis * typing){
 	const DataType * rhsType = typeEqOpd(typing, myExp2);
 
 	if (!lhsType || !rhsType){
-		typing->nodeType(this, ErrorType::produce());
+		typing->nodeType(this, typing->types()->error());
 		return;
 	}
 
 	if (lhsType == rhsType){
-		typing->nodeType(this, BasicType::BOOL());
+		typing->nodeType(this, typing->types()->BOOL());
 		return;
 	}
 
 	const PtrType * lhsPtr = lhsType->asPtr();
 	const PtrType * rhsPtr = rhsType->asPtr();
 	if (lhsPtr && rhsPtr){
-		typing->nodeType(this, BasicType::BOOL());
+		typing->nodeType(this, typing->types()->BOOL());
 		return;
 	}
 
-	typing->badEqOpr(line(), col());
-	typing->nodeType(this, ErrorType::produce());
+	typing->badEqOpr(offset());
+	typing->nodeType(this, typing->types()->error());
 	return;
 }
 
@@ -476,8 +507,8 @@ static const DataType * typeRelOpd(
 	//Errors are invalid, but don't cause re-reports
 	if (type->asError()){ return nullptr; }
 
-	typing->badRelOpd(opd->line(),opd->col());
-	typing->nodeType(opd, ErrorType::produce());
+	typing->badRelOpd(opd->offset());
+	typing->nodeType(opd, typing->types()->error());
 	return nullptr;
 }
 
@@ -486,12 +517,12 @@ void BinaryExpNode::binaryRelTyping(TypeAnalysis * typing){
 	const DataType * rhsType = typeRelOpd(typing, myExp2);
 
 	if (!lhsType || !rhsType){
-		typing->nodeType(this, ErrorType::produce());
+		typing->nodeType(this, typing->types()->error());
 		return;
 	}
 
 	if (lhsType->isInt() && rhsType->isInt()){
-		typing->nodeType(this, BasicType::BOOL());
+		typing->nodeType(this, typing->types()->BOOL());
 		return;
 	}
 	//There is no bad relational operator, so we never 
@@ -519,22 +550,21 @@ void AssignStmtNode::typeAnalysis(TypeAnalysis * typing){
 	myExp->typeAnalysis(typing);
 	const DataType * childType = typing->nodeType(myExp);
 	if (childType->asError()){
-		typing->nodeType(this, ErrorType::produce());
+		typing->nodeType(this, typing->types()->error());
 	} else {
-		typing->nodeType(this, BasicType::VOID());
+		typing->nodeType(this, typing->types()->VOID());
 	}
 }
 
 static const DataType * typeUnaryMath(
-	size_t line, size_t col,
-	TypeAnalysis * typing, ExpNode * exp
+	SrcOffset at, TypeAnalysis * typing, ExpNode * exp
 ){
 	exp->typeAnalysis(typing);
 	const DataType * childType = typing->nodeType(exp);
 
 	//Propagate error but don't re-report
 	if (childType->asError()){
-		return ErrorType::produce();
+		return typing->types()->error();
 	}
 
 	//It's fine to do unary math on an int
@@ -543,18 +573,18 @@ static const DataType * typeUnaryMath(
 	}
 
 	//Any other unary math is an error
-	typing->badMathOpr(line, col);
-	return ErrorType::produce();
+	typing->badMathOpr(at);
+	return typing->types()->error();
 }
 
 void PostDecStmtNode::typeAnalysis(TypeAnalysis * typing){
-	typing->nodeType(this, typeUnaryMath(this->line(), 
-		this->col(), typing, myLVal));
+	typing->nodeType(this, typeUnaryMath(this->offset(), 
+		typing, myLVal));
 }
 
 void PostIncStmtNode::typeAnalysis(TypeAnalysis * typing){
-	typing->nodeType(this, typeUnaryMath(this->line(), 
-		this->col(), typing, myLVal));
+	typing->nodeType(this, typeUnaryMath(this->offset(), 
+		typing, myLVal));
 }
 
 void FromConsoleStmtNode::typeAnalysis(TypeAnalysis * typing){
@@ -567,16 +597,16 @@ void FromConsoleStmtNode::typeAnalysis(TypeAnalysis * typing){
 		return;
 	} else if (childType->asPtr()){
 		//Always bad
-		typing->badWritePtr(myDst->line(), myDst->col());
+		typing->badWritePtr(myDst->offset());
 		return;
 	} else if (childType->asFn()){
-		typing->badReadFn(myDst->line(),myDst->col());
-		typing->nodeType(this, ErrorType::produce());
+		typing->badReadFn(myDst->offset());
+		typing->nodeType(this, typing->types()->error());
 		return;
 	} else {
 		throw new InternalError("unaccounted-for type");
 	}
-	typing->nodeType(this, BasicType::VOID());
+	typing->nodeType(this, typing->types()->VOID());
 }
 
 void ToConsoleStmtNode::typeAnalysis(TypeAnalysis * typing){
@@ -585,18 +615,18 @@ void ToConsoleStmtNode::typeAnalysis(TypeAnalysis * typing){
 
 	//Mark error, but don't re-report
 	if (childType->asError()){
-		typing->nodeType(this, ErrorType::produce());
+		typing->nodeType(this, typing->types()->error());
 		return;
 	}
 
 	//Check for invalid type
 	if (childType->isVoid()){
-		typing->badWriteVoid(mySrc->line(), mySrc->col());
-		typing->nodeType(this, ErrorType::produce());
+		typing->badWriteVoid(mySrc->offset());
+		typing->nodeType(this, typing->types()->error());
 		return;
 	} else if (childType->asFn()){
-		typing->badWriteFn(mySrc->line(), mySrc->col());
-		typing->nodeType(this, ErrorType::produce());
+		typing->badWriteFn(mySrc->offset());
+		typing->nodeType(this, typing->types()->error());
 		return;
 	} else if (childType->asBasic()){
 		//Can write to a var of any other type
@@ -609,35 +639,32 @@ void ToConsoleStmtNode::typeAnalysis(TypeAnalysis * typing){
 		assert(base != nullptr);
 			
 		if (base->isChar()){
-			typing->nodeType(this, BasicType::VOID());
+			typing->nodeType(this, typing->types()->VOID());
 		} else {
-			size_t line = mySrc->line();
-			size_t col = mySrc->line();
-			typing->badWritePtr(line, col);
+			typing->badWritePtr(mySrc->offset());
 		}
 		return;
 	}
 
-	typing->nodeType(this, BasicType::VOID());
+	typing->nodeType(this, typing->types()->VOID());
 }
 
 void IfStmtNode::typeAnalysis(TypeAnalysis * typing){
 	//Start off the typing as void, but may update to error
-	typing->nodeType(this, BasicType::VOID());
+	typing->nodeType(this, typing->types()->VOID());
 
 	myCond->typeAnalysis(typing);
 	const DataType * condType = typing->nodeType(myCond);
 	bool goodCond = true;
 	if (condType->asError()){
-		typing->nodeType(this, ErrorType::produce());
+		typing->nodeType(this, typing->types()->error());
 		goodCond = false;
 	} else if (!condType->isBool()){
 		goodCond = false;
 		typing->badIfCond(
-			myCond->line(), 
-			myCond->col());
+			myCond->offset());
 		typing->nodeType(this, 
-			ErrorType::produce());
+			typing->types()->error());
 	}
 
 	for (auto stmt : *myBody){
@@ -645,9 +672,9 @@ void IfStmtNode::typeAnalysis(TypeAnalysis * typing){
 	}
 
 	if (goodCond){
-		typing->nodeType(this, BasicType::produce(VOID));
+		typing->nodeType(this, typing->types()->VOID());
 	} else {
-		typing->nodeType(this, ErrorType::produce());
+		typing->nodeType(this, typing->types()->error());
 	}
 }
 
@@ -658,9 +685,9 @@ void IfElseStmtNode::typeAnalysis(TypeAnalysis * typing){
 	bool goodCond = true;
 	if (condType->asError()){
 		goodCond = false;
-		typing->nodeType(this, ErrorType::produce());
+		typing->nodeType(this, typing->types()->error());
 	} else if (!condType->isBool()){
-		typing->badIfCond(myCond->line(), myCond->col());
+		typing->badIfCond(myCond->offset());
 		goodCond = false;
 	}
 	for (auto stmt : *myBodyTrue){
@@ -671,9 +698,9 @@ void IfElseStmtNode::typeAnalysis(TypeAnalysis * typing){
 	}
 	
 	if (goodCond){
-		typing->nodeType(this, BasicType::produce(VOID));
+		typing->nodeType(this, typing->types()->VOID());
 	} else {
-		typing->nodeType(this, ErrorType::produce());
+		typing->nodeType(this, typing->types()->error());
 	}
 }
 
@@ -682,21 +709,21 @@ void WhileStmtNode::typeAnalysis(TypeAnalysis * typing){
 	const DataType * condType = typing->nodeType(myCond);
 
 	if (condType->asError()){
-		typing->nodeType(this, ErrorType::produce());
+		typing->nodeType(this, typing->types()->error());
 	} else if (!condType->isBool()){
-		typing->badWhileCond(myCond->line(), myCond->col());
+		typing->badWhileCond(myCond->offset());
 	}
 
 	for (auto stmt : *myBody){
 		stmt->typeAnalysis(typing);
 	}
 
-	typing->nodeType(this, BasicType::VOID());
+	typing->nodeType(this, typing->types()->VOID());
 }
 
 void CallStmtNode::typeAnalysis(TypeAnalysis * typing){
 	myCallExp->typeAnalysis(typing);
-	typing->nodeType(this, BasicType::VOID());
+	typing->nodeType(this, typing->types()->VOID());
 }
 
 void ReturnStmtNode::typeAnalysis(TypeAnalysis * typing){
@@ -704,23 +731,22 @@ void ReturnStmtNode::typeAnalysis(TypeAnalysis * typing){
 	const DataType * fnRet = fnType->getReturnType();
 
 	//Check: shouldn't return anything
-	if (fnRet == BasicType::VOID()){
+	if (fnRet == typing->types()->VOID()){
 		if (myExp != nullptr) {
 			myExp->typeAnalysis(typing);
 			typing->extraRetValue(
-				myExp->line(), 
-				myExp->col()); 
-			typing->nodeType(this, ErrorType::produce());
+				myExp->offset()); 
+			typing->nodeType(this, typing->types()->error());
 		} else {
-			typing->nodeType(this, BasicType::VOID());
+			typing->nodeType(this, typing->types()->VOID());
 		}
 		return;
 	}
 
 	//Check: returns nothing, but should
 	if (myExp == nullptr){
-			typing->badNoRet(line(), col());
-			typing->nodeType(this, ErrorType::produce());
+			typing->badNoRet(offset());
+			typing->nodeType(this, typing->types()->error());
 			return;
 	}
 
@@ -728,46 +754,46 @@ void ReturnStmtNode::typeAnalysis(TypeAnalysis * typing){
 	const DataType * childType = typing->nodeType(myExp);
 
 	if (childType->asError()){
-		typing->nodeType(this, ErrorType::produce());
+		typing->nodeType(this, typing->types()->error());
 		return;
 	}
 
 	if (childType != fnRet){
-		typing->badRetValue(myExp->line(), myExp->col());
-		typing->nodeType(this, ErrorType::produce());
+		typing->badRetValue(myExp->offset());
+		typing->nodeType(this, typing->types()->error());
 		return;
 	}
-	typing->nodeType(this, ErrorType::produce());
+	typing->nodeType(this, typing->types()->error());
 	return;
 }
 
 void CharLitNode::typeAnalysis(TypeAnalysis * typing){
-	BasicType * basic = BasicType::CHAR();
-	typing->nodeType(this, BasicType::CHAR());
+	BasicType * basic = typing->types()->CHAR();
+	typing->nodeType(this, typing->types()->CHAR());
 }
 
 void StrLitNode::typeAnalysis(TypeAnalysis * typing){
-	BasicType * basic = BasicType::CHAR();
-	PtrType * ptr = PtrType::produce(basic, 1);
+	BasicType * basic = typing->types()->CHAR();
+	PtrType * ptr = typing->types()->ptr(basic, 1);
 	typing->nodeType(this, ptr);
 }
 
 void NullPtrNode::typeAnalysis(TypeAnalysis * typing){
-	BasicType * basic = BasicType::VOID();
-	PtrType * ptr = PtrType::produce(basic, 1);
+	BasicType * basic = typing->types()->VOID();
+	PtrType * ptr = typing->types()->ptr(basic, 1);
 	typing->nodeType(this, ptr);
 }
 
 void FalseNode::typeAnalysis(TypeAnalysis * typing){
-	typing->nodeType(this, BasicType::BOOL());
+	typing->nodeType(this, typing->types()->BOOL());
 }
 
 void TrueNode::typeAnalysis(TypeAnalysis * typing){
-	typing->nodeType(this, BasicType::BOOL());
+	typing->nodeType(this, typing->types()->BOOL());
 }
 
 void IntLitNode::typeAnalysis(TypeAnalysis * typing){
-	typing->nodeType(this, BasicType::INT());
+	typing->nodeType(this, typing->types()->INT());
 }
 
 }
@@ -25,28 +25,117 @@ std::string BasicType::getString() const{
 	return res;
 }
 
-DataType * CharTypeNode::getType() { 
-	BasicType * base = BasicType::CHAR();
+DataType * PtrType::incLevel() const {
+	return myContext->ptr(myBasicType, myLevel + 1);
+}
+
+const DataType * PtrType::decLevel() const {
+	int newLevel = myLevel - 1;
+	if (newLevel == 0){
+		return myBasicType;
+	} else {
+		return myContext->ptr(myBasicType, newLevel);
+	}
+}
+
+DataType * PtrType::refType(TypeContext * types, const DataType * type){
+	if (type->asError()){ 
+		return types->error();
+	} else if (const PtrType * t = type->asPtr()){ 
+		return t->incLevel(); 
+	} else if (const BasicType * t = type->asBasic()){ 
+		return types->ptr(t, 1);
+	}
+	return nullptr;
+}
+
+TypeContext::TypeContext(){
+	myBasics[BaseType::INT] = new BasicType(BaseType::INT);
+	myBasics[BaseType::VOID] = new BasicType(BaseType::VOID);
+	myBasics[BaseType::BOOL] = new BasicType(BaseType::BOOL);
+	myBasics[BaseType::CHAR] = new BasicType(BaseType::CHAR);
+	for (BasicType * basic : myBasics){
+		myPtrs[basic->getBaseType()] = new PtrType(this, basic, 1);
+	}
+	myError = new ErrorType();
+}
+
+TypeContext::~TypeContext(){
+	for (BasicType * basic : myBasics){ delete basic; }
+	for (PtrType * ptr : myPtrs){ delete ptr; }
+	delete myError;
+	for (auto entry : ptrTypes){ delete entry.second; }
+	for (auto entry : fnTypes){ delete entry.second; }
+}
+
+PtrType * TypeContext::ptr(const BasicType * base, int level){
+	if (level <= 0){
+		throw new InternalError("bad pointer level");
+	}
+	if (level == 1){
+		return myPtrs[base->getBaseType()];
+	}
+	uint64_t key = static_cast<uint64_t>(base->getBaseType()) << 32;
+	key |= static_cast<uint32_t>(level);
+	std::lock_guard<std::mutex> guard(lock);
+	auto found = ptrTypes.find(key);
+	if (found != ptrTypes.end()){
+		return found->second;
+	}
+	PtrType * newType = new PtrType(this, base, level);
+	ptrTypes.insert(std::make_pair(key, newType));
+	return newType;
+}
+
+size_t TypeContext::fnHash(const std::vector<const DataType *>& formals,
+  const DataType * retType){
+	std::hash<const DataType *> hasher;
+	size_t hash = hasher(retType);
+	for (const DataType * formal : formals){
+		hash = hash * 31 + hasher(formal);
+	}
+	return hash;
+}
+
+FnType * TypeContext::fn(const std::vector<const DataType *>& formals, 
+  const DataType * retType){
+	size_t hash = fnHash(formals, retType);
+	std::lock_guard<std::mutex> guard(lock);
+	auto range = fnTypes.equal_range(hash);
+	for (auto itr = range.first; itr != range.second; ++itr){
+		FnType * candidate = itr->second;
+		if (candidate->myRetType == retType 
+		  && candidate->myFormalTypes == formals){
+			return candidate;
+		}
+	}
+	FnType * newType = new FnType(formals, retType);
+	fnTypes.insert(std::make_pair(hash, newType));
+	return newType;
+}
+
+DataType * CharTypeNode::getType(TypeContext * types) { 
+	BasicType * base = types->CHAR();
 	if (isPtr){
-		return PtrType::produce(base, 1);
+		return types->ptr(base, 1);
 	} else {
 		return base;
 	}
 }
 
-DataType * BoolTypeNode::getType() { 
-	BasicType * base = BasicType::BOOL();
+DataType * BoolTypeNode::getType(TypeContext * types) { 
+	BasicType * base = types->BOOL();
 	if (isPtr){
-		return PtrType::produce(base, 1);
+		return types->ptr(base, 1);
 	} else {
 		return base;
 	}
 }
 
-DataType * IntTypeNode::getType() { 
-	BasicType * base = BasicType::INT();
+DataType * IntTypeNode::getType(TypeContext * types) { 
+	BasicType * base = types->INT();
 	if (isPtr){
-		return PtrType::produce(base, 1);
+		return types->ptr(base, 1);
 	} else {
 		return base;
 	}
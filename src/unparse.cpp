@@ -318,7 +318,7 @@ void LValNode::unparseNested(std::ostream& out){
 
 void IDNode::unparse(std::ostream& out, int indent){
 	doIndent(out, indent);
-	out << name;
+	out << name.text();
 }
 
 void IntLitNode::unparse(std::ostream& out, int indent){
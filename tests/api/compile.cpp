@@ -0,0 +1,66 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string.h>
+
+#include "holeyc.hpp"
+
+//holeycc <infile> -a <3ACFile>, written against the embedding
+// API instead of the driver. The input is handed to the library
+// as a string, as a buffer or as a path, as the first argument
+// says. The 3AC goes to the output file and everything the
+// compilation reports to stderr, for test-api to compare with
+// what holeycc writes.
+
+using holeyc::Compilation;
+using holeyc::Diagnostic;
+
+static void usageAndDie(){
+	std::cerr << "Usage: compile string|buffer|file <infile> <3ACFile>\n";
+	exit(1);
+}
+
+int main(int argc, char * argv[]){
+	if (argc != 4){ usageAndDie(); }
+	std::ifstream in(argv[2]);
+	std::stringstream text;
+	text << in.rdbuf();
+	std::string input = text.str();
+
+	Compilation * comp;
+	if (strcmp(argv[1], "string") == 0){
+		comp = Compilation::fromString(input, argv[2]);
+	} else if (strcmp(argv[1], "buffer") == 0){
+		comp = Compilation::fromBuffer(input.data(), input.size(), argv[2]);
+	} else if (strcmp(argv[1], "file") == 0){
+		comp = Compilation::fromFile(argv[2]);
+	} else {
+		usageAndDie();
+		return 1;
+	}
+	if (!comp->good()){
+		std::cerr << "Bad input " << argv[2] << "\n";
+		delete comp;
+		return 1;
+	}
+
+	std::string prog;
+	if (comp->threeAC(prog)){
+		std::ofstream out(argv[3]);
+		out << prog << "\n";
+	}
+	std::cerr << comp->diagnosticText();
+
+	//The driver has the last word when analysis, rather than an
+	// internal error, is what stopped the compilation
+	int status = 0;
+	const std::vector<Diagnostic>& diags = comp->diagnostics();
+	if (!diags.empty() && diags.back().severity == Diagnostic::INTERNAL){
+		status = 1;
+	} else if (comp->typeAnalysis() == nullptr){
+		std::cerr << "Type Analysis Failed\n";
+		status = 1;
+	}
+	delete comp;
+	return status;
+}